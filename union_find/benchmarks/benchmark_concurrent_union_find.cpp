@@ -0,0 +1,63 @@
+#include <utils/union_find.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace utils;
+typedef t_concurrent_union_find         union_find_t;
+typedef union_find_t::vertex_t          vertex_t;
+typedef std::pair<vertex_t, vertex_t>   edge_t;
+
+//Streams the edges into one structure from 1 up to all cores, and
+//compares with the sequential t_union_find.
+//usage : benchmark_concurrent_union_find.exe [#vertices] [#edges]
+int main(int argc, char** argv)
+{
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::size_t m = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4 * n;
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  //random edges
+  std::vector<edge_t> edges;
+  edges.reserve(m);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<vertex_t> dist(0, n - 1);
+  for(std::size_t i = 0; i < m; i++)
+    edges.push_back(edge_t(dist(rng), dist(rng)));
+
+  //sequential reference
+  t_union_find<> reference;
+  reference.make_sets(n);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(const edge_t& e : edges)
+    reference.union_sets(e.first, e.second);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "t_union_find            : 1 thread(s), " << seconds << " s, " << m / seconds << " edges/s, #independent sets " << reference.number_of_independent_sets() << std::endl;
+
+  //powers of 2 threads, and all cores
+  std::vector<unsigned> thread_counts;
+  for(unsigned nb_threads = 1; nb_threads < max_threads; nb_threads *= 2)
+    thread_counts.push_back(nb_threads);
+  thread_counts.push_back(max_threads);
+
+  for(unsigned nb_threads : thread_counts)
+    {
+      union_find_t uf(n);
+      start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for(unsigned t = 0; t < nb_threads; t++)
+	threads.push_back(std::thread([&uf, &edges, t, nb_threads](){
+	      for(std::size_t i = t; i < edges.size(); i += nb_threads)
+		uf.union_sets(edges[i].first, edges[i].second);
+	    }));
+      for(std::thread& thread : threads)
+	thread.join();
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "t_concurrent_union_find : " << nb_threads << " thread(s), " << seconds << " s, " << m / seconds << " edges/s, #independent sets " << uf.number_of_independent_sets() << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include <utils/union_find.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace utils;
+
+//Unions random edges, then compares a loop of find_set with find_batch
+//on random queries.
+template <class _union_find>
+void benchmark(const char* name, std::size_t n, std::size_t m, std::size_t q)
+{
+  typedef typename _union_find::vertex_t vertex_t;
+
+  _union_find uf;
+  uf.make_sets(n);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<vertex_t> dist(0, vertex_t(n - 1));
+  for(std::size_t i = 0; i < m; i++)
+    uf.union_sets(dist(rng), dist(rng));
+
+  std::vector<vertex_t> queries(q);
+  for(vertex_t& u : queries)
+    u = dist(rng);
+  std::vector<vertex_t> leaders(q);
+
+  //the loop runs on a copy, so that its path compression does not
+  //help find_batch
+  _union_find copy = uf;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(std::size_t i = 0; i < q; i++)
+    leaders[i] = copy.find_set(queries[i]);
+  double loop_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  uf.find_batch(queries.begin(), queries.end(), leaders.begin());
+  double batch_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << name << " : find_set " << q / loop_seconds << " finds/s, find_batch " << q / batch_seconds << " finds/s, speedup " << loop_seconds / batch_seconds << std::endl;
+}
+
+//usage : benchmark_find_batch.exe [#vertices] [#edges] [#queries]
+int main(int argc, char** argv)
+{
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+  std::size_t m = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : n / 2;
+  std::size_t q = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : n;
+
+  benchmark<t_union_find<> >("t_union_find<>                  ", n, m, q);
+  benchmark<t_union_find<false, t_no_compression> >("t_union_find<t_no_compression> ", n, m, q);
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include <utils/union_find/kruskal.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace utils;
+
+typedef t_kruskal<double, std::size_t> kruskal_t;
+typedef kruskal_t::edge_t              edge_t;
+
+//Returns the weight of the minimum spanning forest computed by sorting
+//all the edges, then unioning them in order.
+double sort_then_union(std::size_t n, std::vector<edge_t>& edges)
+{
+  std::sort(edges.begin(), edges.end(), [](const edge_t& a, const edge_t& b){return std::get<2>(a) < std::get<2>(b);});
+  t_union_find<false, t_link_by_size> uf;
+  uf.make_sets(n);
+  double total = 0;
+  for(const edge_t& e : edges)
+    {
+      std::size_t u = uf.find_set(std::get<0>(e));
+      std::size_t v = uf.find_set(std::get<1>(e));
+      if(u == v)
+	continue;
+      uf.union_sets(u, v);
+      total += std::get<2>(e);
+      if(uf.number_of_independent_sets() == 1)
+	break;
+    }
+  return total;
+}
+
+//Compares the sort-then-union loop with t_kruskal on a random graph
+//with uniform weights.
+void benchmark(std::size_t n, std::size_t m, unsigned nb_threads)
+{
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::size_t> vertex(0, n - 1);
+  std::uniform_real_distribution<double> weight(0, 1);
+  std::vector<edge_t> edges(m);
+  for(edge_t& e : edges)
+    e = edge_t(vertex(rng), vertex(rng), weight(rng));
+  std::vector<edge_t> copy = edges;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  double loop_total = sort_then_union(n, copy);
+  double loop_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  kruskal_t kruskal(nb_threads);
+  start = std::chrono::steady_clock::now();
+  kruskal.run(n, edges);
+  double kruskal_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << n << " vertices, " << m << " edges : sort then union " << loop_seconds << "s, t_kruskal " << kruskal_seconds << "s, speedup " << loop_seconds / kruskal_seconds << std::endl;
+  if(std::abs(loop_total - kruskal.total_weight()) > 1e-6 * loop_total)
+    std::cerr << "different forest weights " << loop_total << " " << kruskal.total_weight() << std::endl;
+}
+
+//usage : benchmark_kruskal.exe [#vertices] [#threads]
+int main(int argc, char** argv)
+{
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  unsigned nb_threads = argc > 2 ? unsigned(std::strtoul(argv[2], nullptr, 10)) : 0;
+
+  for(std::size_t degree : {2, 8, 32})
+    benchmark(n, degree * n, nb_threads);
+
+  return 0;
+}
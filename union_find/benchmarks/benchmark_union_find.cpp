@@ -0,0 +1,225 @@
+#include "graph_generators.hpp"
+#include <utils/union_find.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace utils;
+
+//Bytes allocated and not freed yet, counted by the global operators
+//new and delete below, to measure the memory of each structure.
+static std::size_t allocated_bytes = 0;
+
+void* operator new(std::size_t size)
+{
+  char* p = static_cast<char*>(std::malloc(size + sizeof(std::max_align_t)));
+  if(p == nullptr)
+    throw std::bad_alloc();
+  *reinterpret_cast<std::size_t*>(p) = size;
+  allocated_bytes += size;
+  return p + sizeof(std::max_align_t);
+}
+
+void operator delete(void* q) noexcept
+{
+  if(q == nullptr)
+    return;
+  char* p = static_cast<char*>(q) - sizeof(std::max_align_t);
+  allocated_bytes -= *reinterpret_cast<std::size_t*>(p);
+  std::free(p);
+}
+
+//Textbook Union-Find, as the reference : path compression in two
+//passes and union by rank.
+class t_reference_union_find{
+  std::vector<std::size_t>   m_parents;
+  std::vector<unsigned char> m_ranks;
+
+public:
+
+  void make_sets(std::size_t n)
+  {
+    for(std::size_t u = 0; u < n; u++)
+      {
+	this->m_parents.push_back(u);
+	this->m_ranks.push_back(0);
+      }
+  }
+
+  std::size_t find_set(std::size_t u)
+  {
+    std::size_t root = u;
+    while(this->m_parents[root] != root)
+      root = this->m_parents[root];
+    while(this->m_parents[u] != root)
+      {
+	std::size_t next = this->m_parents[u];
+	this->m_parents[u] = root;
+	u = next;
+      }
+    return root;
+  }
+
+  std::size_t union_sets(std::size_t u, std::size_t v)
+  {
+    u = this->find_set(u);
+    v = this->find_set(v);
+    if(u == v)
+      return u;
+    if(this->m_ranks[u] < this->m_ranks[v])
+      std::swap(u, v);
+    else if(this->m_ranks[u] == this->m_ranks[v])
+      this->m_ranks[u]++;
+    this->m_parents[v] = u;
+    return u;
+  }
+
+  template<class _output_iterator>
+  _output_iterator independent_set(std::size_t u, _output_iterator out)
+  {
+    u = this->find_set(u);
+    for(std::size_t v = 0; v < this->m_parents.size(); v++)
+      if(u == this->find_set(v))
+	*out = v;
+    return out;
+  }
+};
+
+//The log of the structures with Rewind, rewinded to the start, which
+//returns the number of operations rewinded, and its memory in bytes.
+
+template <class _union_find>
+std::size_t rewind_all(_union_find&)
+{
+  return 0;
+}
+
+template <class... _policies>
+std::size_t rewind_all(t_union_find<true, _policies...>& uf)
+{
+  std::size_t nb_operations = 0;
+  while(uf.log_size() > 0)
+    {
+      uf.rewind();
+      nb_operations++;
+    }
+  return nb_operations;
+}
+
+template <class _union_find>
+std::size_t log_memory(const _union_find&)
+{
+  return 0;
+}
+
+template <class... _policies>
+std::size_t log_memory(const t_union_find<true, _policies...>& uf)
+{
+  return uf.log_memory();
+}
+
+//Nanoseconds per operation since start, for nb_operations operations.
+double ns_per_operation(std::chrono::steady_clock::time_point start, std::size_t nb_operations)
+{
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return nb_operations > 0 ? ns / double(nb_operations) : 0;
+}
+
+//Times each operation on one graph, and writes one JSON object.
+template <class _union_find>
+void benchmark(const std::string& graph, const std::string& structure, std::size_t n, const std::vector<edge_t>& edges, bool first)
+{
+  const std::size_t NB_FINDS = n;
+  const std::size_t NB_SETS = 8;
+
+  std::mt19937_64 rng(7);
+  std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+  std::vector<std::size_t> queries(NB_FINDS);
+  for(std::size_t& u : queries)
+    u = dist(rng);
+
+  std::size_t allocated = allocated_bytes;
+  _union_find* uf = new _union_find();
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uf->make_sets(n);
+  double make_sets_ns = ns_per_operation(start, n);
+
+  start = std::chrono::steady_clock::now();
+  for(const edge_t& e : edges)
+    uf->union_sets(e.first, e.second);
+  double union_ns = ns_per_operation(start, edges.size());
+  std::size_t log_bytes = log_memory(*uf);
+  double bytes_per_vertex = double(allocated_bytes - allocated - log_bytes) / double(n);
+
+  std::size_t checksum = 0;
+  start = std::chrono::steady_clock::now();
+  for(std::size_t u : queries)
+    checksum += uf->find_set(u);
+  double find_ns = ns_per_operation(start, NB_FINDS);
+
+  std::vector<std::size_t> members;
+  members.reserve(n);
+  start = std::chrono::steady_clock::now();
+  for(std::size_t i = 0; i < NB_SETS; i++)
+    {
+      members.clear();
+      uf->independent_set(queries[i], std::back_inserter(members));
+      checksum += members.size();
+    }
+  double independent_set_ns = ns_per_operation(start, NB_SETS);
+
+  start = std::chrono::steady_clock::now();
+  std::size_t nb_rewinds = rewind_all(*uf);
+  double rewind_ns = ns_per_operation(start, nb_rewinds);
+
+  delete uf;
+
+  std::cout << (first ? "  " : ", ") << "{\"graph\": \"" << graph << "\", \"structure\": \"" << structure << "\""
+	    << ", \"vertices\": " << n << ", \"edges\": " << edges.size()
+	    << ", \"make_sets_ns\": " << make_sets_ns << ", \"union_ns\": " << union_ns << ", \"find_ns\": " << find_ns
+	    << ", \"independent_set_ns\": " << independent_set_ns << ", \"rewind_ns\": " << rewind_ns
+	    << ", \"bytes_per_vertex\": " << bytes_per_vertex << ", \"log_bytes\": " << log_bytes
+	    << ", \"checksum\": " << checksum << "}" << std::endl;
+}
+
+//Times the structures on each graph at several sizes, and prints the
+//results as a JSON array with one object per structure, graph and
+//size; the times are in nanoseconds per operation (per vertex for
+//make_sets, per edge for the unions, per operation rewinded, and per
+//call for independent_set).
+//usage : benchmark_union_find.exe [max #vertices]
+int main(int argc, char** argv)
+{
+  std::size_t max_n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 20;
+
+  bool first = true;
+  std::cout << "[" << std::endl;
+  for(std::size_t n = std::min<std::size_t>(max_n, 1 << 14); n <= max_n; n *= 8)
+    {
+      std::vector<std::pair<std::string, std::vector<edge_t> > > graphs;
+      graphs.push_back(std::make_pair(std::string("random"), random_graph(n, 2 * n)));
+      graphs.push_back(std::make_pair(std::string("grid"), grid_graph(n)));
+      graphs.push_back(std::make_pair(std::string("power_law"), power_law_graph(n)));
+      graphs.push_back(std::make_pair(std::string("path"), path_graph(n)));
+      graphs.push_back(std::make_pair(std::string("star"), star_graph(n)));
+
+      for(const auto& graph : graphs)
+	{
+	  benchmark<t_union_find<false> >(graph.first, "t_union_find<false>", n, graph.second, first);
+	  first = false;
+	  benchmark<t_union_find<true> >(graph.first, "t_union_find<true>", n, graph.second, first);
+	  benchmark<t_reference_union_find>(graph.first, "reference", n, graph.second, first);
+	}
+      if(n > max_n / 8)
+	break;
+    }
+  std::cout << "]" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_BENCHMARKS_GRAPH_GENERATORS_HPP_
+#define _UTILS_UNION_FIND_BENCHMARKS_GRAPH_GENERATORS_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+  Synthetic graphs for the benchmarks, as lists of edges over the
+  vertices 0 to n-1. They are deterministic for a given seed, so that
+  two runs measure the same unions.
+*/
+
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+//m edges with uniform random endpoints
+inline std::vector<edge_t> random_graph(std::size_t n, std::size_t m, std::uint64_t seed = 42)
+{
+  std::vector<edge_t> edges;
+  edges.reserve(m);
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+  for(std::size_t i = 0; i < m; i++)
+    edges.push_back(edge_t(dist(rng), dist(rng)));
+  return edges;
+}
+
+//4-connected grid of about n vertices, in raster order : a few large
+//sets growing row by row
+inline std::vector<edge_t> grid_graph(std::size_t n)
+{
+  std::size_t width = std::max<std::size_t>(1, std::size_t(std::sqrt(double(n))));
+  std::vector<edge_t> edges;
+  edges.reserve(2 * n);
+  for(std::size_t u = 0; u < n; u++)
+    {
+      if((u + 1) % width != 0 && u + 1 < n)
+	edges.push_back(edge_t(u, u + 1));
+      if(u + width < n)
+	edges.push_back(edge_t(u, u + width));
+    }
+  return edges;
+}
+
+//preferential attachment : each new vertex is linked to degree
+//vertices chosen with a probability proportional to their degree, so
+//that a few hubs are in most of the edges
+inline std::vector<edge_t> power_law_graph(std::size_t n, std::size_t degree = 4, std::uint64_t seed = 42)
+{
+  std::vector<edge_t> edges;
+  edges.reserve(degree * n);
+  std::vector<std::size_t> endpoints;//each vertex once per incident edge
+  endpoints.reserve(2 * degree * n + 1);
+  endpoints.push_back(0);
+  std::mt19937_64 rng(seed);
+  for(std::size_t u = 1; u < n; u++)
+    {
+      for(std::size_t i = 0; i < degree; i++)
+	{
+	  std::size_t v = endpoints[std::uniform_int_distribution<std::size_t>(0, endpoints.size() - 1)(rng)];
+	  edges.push_back(edge_t(u, v));
+	  endpoints.push_back(v);
+	}
+      for(std::size_t i = 0; i < degree; i++)
+	endpoints.push_back(u);
+    }
+  return edges;
+}
+
+//path 0 - 1 - ... - n-1 unioned from its end, so that each union
+//links a leader below the growing set : without path compression nor
+//linking, the tree is a chain of n vertices
+inline std::vector<edge_t> path_graph(std::size_t n)
+{
+  std::vector<edge_t> edges;
+  edges.reserve(n);
+  for(std::size_t u = n - 1; u > 0; u--)
+    edges.push_back(edge_t(u - 1, u));
+  return edges;
+}
+
+//star : every vertex is linked to the vertex 0
+inline std::vector<edge_t> star_graph(std::size_t n)
+{
+  std::vector<edge_t> edges;
+  edges.reserve(n);
+  for(std::size_t u = 1; u < n; u++)
+    edges.push_back(edge_t(0, u));
+  return edges;
+}
+
+#endif
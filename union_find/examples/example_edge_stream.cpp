@@ -0,0 +1,45 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/edge_stream.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace utils;
+typedef t_union_find<false, t_vertex_index<std::uint64_t> > union_find_t;
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+    {
+      std::cerr << "usage : " << argv[0] << " <edge file> [text|u32|u64] [#threads]" << std::endl;
+      return 1;
+    }
+
+  //format of the file and number of threads (0 for all the cores)
+  t_edge_stream::format_t format = t_edge_stream::TEXT;
+  if(argc > 2 && std::strcmp(argv[2], "u32") == 0)
+    format = t_edge_stream::BINARY_32;
+  else if(argc > 2 && std::strcmp(argv[2], "u64") == 0)
+    format = t_edge_stream::BINARY_64;
+  unsigned nb_threads = argc > 3 ? unsigned(std::atoi(argv[3])) : 0;
+
+  //streams the edges in the Union-Find structure, the vertices being
+  //created as they appear
+  union_find_t uf;
+  t_edge_stream stream(format, nb_threads);
+  auto start = std::chrono::steady_clock::now();
+  if(!stream.union_file(argv[1], uf))
+    {
+      std::cerr << "cannot read " << argv[1] << " or a vertex is out of range" << std::endl;
+      return 1;
+    }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  //print stats
+  std::cout << "#vertices, #edges, #components : " << uf.size() << " " << stream.number_of_edges() << " " << uf.number_of_independent_sets() << std::endl;
+  std::cout << "time (s), edges/s, MB/s : " << seconds << " " << (seconds > 0 ? stream.number_of_edges() / seconds : 0)
+	    << " " << (seconds > 0 ? stream.number_of_bytes() / seconds / 1e6 : 0) << std::endl;
+
+  return 0;
+}
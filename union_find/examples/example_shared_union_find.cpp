@@ -0,0 +1,55 @@
+#include <utils/union_find/shared_union_find.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace utils;
+
+int main(int argc, char** argv)
+{
+  std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  unsigned nb_processes = argc > 2 ? unsigned(std::atoi(argv[2])) : 4;
+  const char* name = "/example_shared_union_find";
+
+  //the segment is created before forking, so that it is initialized
+  //when the workers attach it
+  t_shared_union_find::remove(name);
+  t_shared_union_find uf;
+  if(!uf.create(name, n))
+    {
+      std::cerr << "cannot create the shared segment " << name << std::endl;
+      return 1;
+    }
+
+  //each worker process attaches the segment by name and unions its
+  //own share of random edges
+  for(unsigned p = 0; p < nb_processes; p++)
+    if(::fork() == 0)
+      {
+	t_shared_union_find worker;
+	if(!worker.attach(name))
+	  std::_Exit(1);
+	std::mt19937_64 rng(p);
+	std::uniform_int_distribution<std::size_t> dist(0, n - 1);
+	for(std::size_t i = 0; i < n / nb_processes; i++)
+	  worker.union_sets(dist(rng), dist(rng));
+	worker.detach();
+	std::_Exit(0);
+      }
+  bool ok = true;
+  for(unsigned p = 0; p < nb_processes; p++)
+    {
+      int status = 0;
+      ::wait(&status);
+      ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+  //the partition built by the workers is read in place
+  std::cout << "#vertices, #processes, #components : " << uf.size() << " " << nb_processes << " " << uf.number_of_independent_sets() << std::endl;
+  uf.detach();
+  t_shared_union_find::remove(name);
+
+  return ok ? 0 : 1;
+}
@@ -17,8 +17,18 @@ permissions and limitations under the License.
 #define _UTILS_UNION_FIND_HPP_
 
 #include <cassert>
+#include <limits>
 #include <vector>
-#include <stack>
+#include <iterator>
+#include <tuple>
+#include <utils/union_find/policies.hpp>
+#include <utils/union_find/storage.hpp>
+#include <utils/union_find/operation_log.hpp>
+#include <utils/union_find/concurrent_union_find.hpp>
+#include <utils/union_find/parallel.hpp>
+#include <utils/union_find/frozen_union_find.hpp>
+#include <utils/union_find/serialization.hpp>
+#include <utils/union_find/prefetch.hpp>
 
 namespace utils{
   /*
@@ -35,16 +45,51 @@ namespace utils{
     of the main operations, but it takes extra memory space. If the
     template tag is false, then no operation is recorded and the rewind
     feature is disabled, saving memory.
+
+    The strategies of the find and union operations are chosen with
+    policies following the rewind tag (see policies.hpp) : the path
+    compression (t_full_compression by default, t_path_halving,
+    t_path_splitting or t_no_compression) and the linking of the
+    leaders (t_link_by_rank by default, t_link_by_size or
+    t_link_by_random_index). None of them uses recursion. The member
+    lists (t_member_lists) enumerate a set in O(|set|). The memory
+    layout is chosen with the vertex index type (t_vertex_index, of
+    std::size_t by default) and with the storage of the weights
+    (t_weights_in_array by default, or t_weights_in_parents). For
+    instance, with 32 bits indices and union by rank, a vertex costs 5
+    bytes with the weights in an array, and 4 bytes with the weights
+    in the parents. The reset of all the vertices is O(n) by default
+    (t_eager_reset), or O(1) with generation stamps (t_lazy_reset)
+    when no other policy has a state per vertex to reset.
+    The vertices can be removed with t_free_list, their indices being
+    recycled by make_set, and compact() renumbers the vertices alive
+    into consecutive indices. The operations are counted by stats()
+    with t_stats, at no cost without it (t_no_stats). All the arrays
+    are allocated by the allocator policy, std::allocator by default,
+    or huge pages with t_huge_pages. The log of the Rewind feature is
+    kept in memory (t_memory_log), or spilled to a temporary file
+    beyond a bounded tail (t_spilling_log).
   */
 
-  template <bool WITH_REWIND = false>
+  template <bool WITH_REWIND = false, class... _policies>
   class t_union_find{
 
     //Types
 
   public:
 
-    typedef std::size_t vertex_t;
+    typedef typename t_select_policy<t_vertex_index_policy_tag, t_vertex_index<std::size_t>, _policies...>::type::type vertex_t;
+    typedef typename t_select_policy<t_allocator_policy_tag, t_allocator<std::allocator<char> >, _policies...>::type::type allocator_t;
+
+    typedef typename t_select_policy<t_compression_policy_tag, t_full_compression, _policies...>::type      compression_t;
+    typedef typename t_select_policy<t_linking_policy_tag, t_link_by_rank, _policies...>::type            linking_t;
+    typedef typename t_select_policy<t_weight_storage_policy_tag, t_weights_in_array, _policies...>::type weight_storage_t;
+    typedef typename t_select_policy<t_member_policy_tag, t_no_member_lists, _policies...>::type          member_policy_t;
+    typedef typename t_select_policy<t_reset_policy_tag, t_eager_reset, _policies...>::type               reset_policy_t;
+    typedef typename t_select_policy<t_aggregate_policy_tag, t_no_aggregate, _policies...>::type          aggregate_policy_t;
+    typedef typename t_select_policy<t_removal_policy_tag, t_no_removal, _policies...>::type              removal_policy_t;
+    typedef typename t_select_policy<t_stats_policy_tag, t_no_stats, _policies...>::type                  stats_policy_t;
+    typedef typename t_select_policy<t_log_policy_tag, t_memory_log, _policies...>::type                   log_policy_t;
 
     enum operation_t{
       NONE,
@@ -53,31 +98,48 @@ namespace utils{
       UNION_SETS
     };
 
+    //checkpoint of the structure, returned by mark()
+    class mark_t{
+      friend class t_union_find;
+      std::size_t m_position;//size of the log at the checkpoint
+      std::size_t m_depth;//number of enclosing checkpoints
+      mark_t(std::size_t position, std::size_t depth) : m_position(position), m_depth(depth) {}
+    public:
+      mark_t(void) : m_position(0), m_depth(0) {}
+    };
+
   private:
 
-    struct operation_entry_t{
-      operation_t operation;//the operation
-      vertex_t    u;//the first vertex in the operation
-      vertex_t    v;//the second vertex in the operation, if any
-      bool        increased_rank;//indicates if the rank has been increased by the operation
-      operation_entry_t(operation_t operation, vertex_t u, vertex_t v, bool increased_rank)
-	: operation(operation),
-	  u(u),
-	  v(v),
-	  increased_rank(increased_rank)
-      {}
-    };
+    typedef typename log_policy_t::template log<vertex_t, allocator_t>::type operations_t;
+
+    typedef typename linking_t::template weight<vertex_t>::type                                                  weight_t;
+    typedef typename weight_storage_t::template storage<vertex_t, weight_t, linking_t::USES_WEIGHT, allocator_t>::type base_storage_t;
+    typedef typename reset_policy_t::template storage<base_storage_t>::type                                       reset_storage_t;
+    typedef typename stats_policy_t::template storage<reset_storage_t>::type                                      storage_t;
+    typedef typename member_policy_t::template data<vertex_t, allocator_t>                                        members_t;
+    typedef typename aggregate_policy_t::template data<vertex_t, allocator_t>                                     aggregates_t;
+    typedef typename removal_policy_t::template data<vertex_t, allocator_t>                                       removals_t;
+    typedef typename stats_policy_t::template data<vertex_t>                                                      stats_t;
 
-    typedef std::stack<operation_entry_t> operations_t;
+    static_assert(!removals_t::ENABLED || !WITH_REWIND, "the removals cannot be rewinded");
+    static_assert(!removals_t::ENABLED || !aggregates_t::ENABLED, "the aggregate of a set cannot forget a removed vertex");
+
+  public:
+
+    typedef typename aggregates_t::value_type aggregate_t;
   
     //Attributes
   
   private:
   
-    std::vector<vertex_t> m_parents;
-    std::vector<vertex_t> m_ranks;
-    std::size_t           m_nb_cc;
-    operations_t          m_operations;
+    storage_t                m_storage;
+    members_t                m_members;
+    aggregates_t             m_aggregates;
+    removals_t               m_removals;
+    stats_t                  m_stats;
+    std::size_t              m_nb_cc;
+    operations_t             m_operations;
+    std::vector<std::size_t> m_marks;//log sizes at the checkpoints alive
 
     //Constructors
 
@@ -92,14 +154,31 @@ namespace utils{
     //Check that u is a vertex of this structure.
     bool is_valid(vertex_t u)const;
 
-    //Record the make set in the stack.
-    void record_make_set(vertex_t u);
+    //Find the leader of u without path compression.
+    vertex_t leader(vertex_t u)const;
+
+    //Replace the n vertices by their leaders, without path
+    //compression, interleaving FIND_WINDOW walks that prefetch their
+    //next parents.
+    void leaders_window(vertex_t* vertices, std::size_t n)const;
+
+  public:
+
+    //Header of the files saved by this structure, whose layout
+    //depends on the policies.
+    static t_union_find_file_header file_header(std::size_t size, std::size_t nb_cc, std::size_t log_words);
+
+  private:
 
-    //Record the find set in the stack.
-    void record_find_set(vertex_t u, vertex_t v);
+    //Record the make set in the log.
+    void record_make_set(void);
 
-    //Record the union sets in the stack.
-    void record_union_sets(vertex_t u, vertex_t v, bool increased_rank);
+    //Release all the vertices of the set of the leader u to the free
+    //list.
+    void release_set(vertex_t u);
+
+    //Record the union sets in the log.
+    void record_union_sets(vertex_t u, vertex_t v, bool increased_rank, weight_t weight);
 
     //Base operations
 
@@ -108,22 +187,66 @@ namespace utils{
     //removes all vertices from the structure (O(n))
     void clear(void);
 
-    //does one independent set per vertex (O(n))
+    //does one independent set per vertex (O(n)); with t_lazy_reset,
+    //the parents and weights are reset in O(1), so that reset() is
+    //O(1) only without Rewind, member lists, aggregate nor free list,
+    //each of them resetting its own arrays in O(n)
     void reset(void);
 
     //adds a new vertex (O(1))
     vertex_t make_set(void);
 
-    //adds n new vertices (O(n))
+    //adds a new vertex with the initial value of its aggregate (O(1))
+    vertex_t make_set(const aggregate_t& value);
+
+    //adds n new vertices with one resize of the arrays (O(n))
     void make_sets(std::size_t n);
 
-    //finds the leader of the set containing u using path compression
-    //(~O(1))
+    //allocates the arrays for n vertices, so that adding vertices up
+    //to n does not reallocate them (O(n))
+    void reserve(std::size_t n);
+
+    //finds the leader of the set containing u using the compression
+    //policy (~O(1))
     vertex_t find_set(vertex_t u);
 
     //unions two sets if they are disjoint (~O(1))
     vertex_t union_sets(vertex_t u, vertex_t v);
 
+    //Batch operations
+
+  public:
+
+    //unions the two vertices of each edge in [first, last), splitting
+    //the edges across nb_threads threads (0 for all the cores). The
+    //resulting partition is the one of a sequential loop of
+    //union_sets. The edges are pairs or tuples of existing vertices
+    //in a random access range (~O(n + m / #threads))
+    template<class _random_access_iterator>
+    void union_batch(_random_access_iterator first, _random_access_iterator last, unsigned nb_threads = 0);
+
+    //unions the two vertices of each edge of the container, and
+    //returns the number of independent sets (~O(n + m / #threads))
+    template<class _edges>
+    std::size_t connected_components(const _edges& edges, unsigned nb_threads = 0);
+
+    //number of finds interleaved by find_batch, and number of
+    //vertices buffered from the input
+    static const std::size_t FIND_WINDOW = 32;
+    static const std::size_t FIND_BUFFER = 256;
+
+    //writes the leader of each vertex of [first, last) to out. The
+    //finds are interleaved FIND_WINDOW at a time so that the cache
+    //misses of the walks overlap; there is no path compression, hence
+    //nothing is recorded for the Rewind feature (~O(m))
+    template<class _input_iterator, class _output_iterator>
+    _output_iterator find_batch(_input_iterator first, _input_iterator last, _output_iterator out)const;
+
+    //writes, for each pair of vertices of [first, last), true iff they
+    //are in the same set, interleaving the finds as find_batch (~O(m))
+    template<class _input_iterator, class _output_iterator>
+    _output_iterator same_set_batch(_input_iterator first, _input_iterator last, _output_iterator out)const;
+
     //Independent sets
 
   public:
@@ -134,257 +257,865 @@ namespace utils{
     //returns the number of vertices in the structure (O(1))
     std::size_t size(void)const;
 
+    //returns the maximum number of vertices allowed by the vertex
+    //index and the weight storage (O(1))
+    static std::size_t max_size(void);
+
     //returns the number of independent sets in the structure (O(1))
     std::size_t number_of_independent_sets(void)const;
 
-    //fills the input container with all the leaders (O(n))
+    //fills the input container with all the leaders (O(n)); with
+    //t_free_list, a set whose leader was removed is reported by its
+    //first vertex alive instead, so that no removed vertex is reported
     template<class _output_iterator>
     _output_iterator leaders(_output_iterator out);
 
     //fills the input container with all the vertices in the set
-    //containing u (O(n))
+    //containing u, in increasing order (O(n)), or in the order of the
+    //member list with t_member_lists (O(|set|)), the removed vertices
+    //being skipped
     template<class _output_iterator>
     _output_iterator independent_set(vertex_t u, _output_iterator out);
 
+    //returns the number of vertices alive in the set containing u
+    //(O(n)), with t_member_lists, t_link_by_size or t_free_list
+    //(~O(1))
+    std::size_t set_size(vertex_t u);
+
+    //returns an immutable snapshot of the independent sets, with
+    //dense labels and the members of each set, whose queries are
+    //const and thread-safe; the removed vertices are ABSENT from the
+    //snapshot, and the structure is not modified (O(n / #threads + k)
+    //for k sets)
+    t_frozen_union_find<vertex_t> freeze(unsigned nb_threads = 0)const;
+
+    //returns the aggregate of the values of the set containing u
+    //(~O(1))
+    const aggregate_t& aggregate(vertex_t u);
+
+    //Removal
+
+  public:
+
+    //index mapped by compact() to the removed vertices
+    static const vertex_t REMOVED;
+
+    //removes the vertex u, that stays in its set as a tombstone until
+    //the set is removed or compacted; when it was the last vertex
+    //alive of its set, the whole set is removed (~O(1), O(n) for the
+    //last vertex, O(|set|) with t_member_lists)
+    void remove_vertex(vertex_t u);
+
+    //removes all the vertices of the set containing u, their indices
+    //being recycled by make_set (O(n), O(|set|) with t_member_lists)
+    void remove_set(vertex_t u);
+
+    //returns true iff u was removed (O(1))
+    bool is_removed(vertex_t u)const;
+
+    //returns the number of removed vertices whose index can be
+    //recycled (O(1))
+    std::size_t number_of_free_vertices(void)const;
+
+    //renumbers the vertices alive into the indices 0 to k-1, keeping
+    //their order and their sets, and returns the new index of each
+    //former vertex, REMOVED for the removed ones; the memory allocated
+    //and the statistics are kept (~O(n))
+    std::vector<vertex_t> compact(void);
+
+    //Statistics
+
+  public:
+
+    //returns the counters of the operations since the creation or the
+    //last reset_stats, and the histogram of the weights of the
+    //leaders, with t_stats; the const batch queries are not counted
+    //(O(n))
+    t_union_find_stats stats(void)const;
+
+    //sets the counters to 0, with t_stats (O(1))
+    void reset_stats(void);
+
     //Rewind
 
   public:
 
+    //allocates the memory of the log for n words, an union taking 3
+    //words (4 with t_weights_in_parents) and a find k + 2 words for
+    //a path of k vertices (O(n))
+    void reserve_log(std::size_t n);
+
+    //returns the number of words in the log (O(1))
+    std::size_t log_size(void)const;
+
+    //returns the memory allocated by the log in bytes, without the
+    //words spilled to the file by t_spilling_log (O(1))
+    std::size_t log_memory(void)const;
+
     //rewinds the union-find data structure by 1 operation, returns the
-    //rewinded operation
+    //rewinded operation; a find set is rewinded in one operation
     operation_t rewind(void);
 
-    //rewinds the union-find data structure just before u was inserted
+    //rewinds the union-find data structure just before u was inserted;
+    //stops when the log is exhausted, leaving size() > u if u was
+    //inserted before the oldest state (see commit and load)
     void rewind(vertex_t u);
   
     //rewinds the union-find data structure just before u and v were in
     //the same set
     void rewind(vertex_t u, vertex_t v);
+
+    //Serialization
+
+  public:
+
+    //saves the structure in a binary file, with its rewind log if
+    //with_log is true, returns false on failure; not available with
+    //an aggregate policy (O(n))
+    bool save(const char* path, bool with_log = true)const;
+
+    //loads a structure saved with the same policies, returns false on
+    //failure or on a corrupt file, in which case the structure is
+    //cleared; without a saved log, the loaded state is the oldest
+    //state to rewind to : rewind() returns NONE there, and rewind(u)
+    //stops there for any vertex u loaded from the file (O(n))
+    bool load(const char* path);
+
+    //Checkpoints
+
+  public:
+
+    //returns a checkpoint of the current state, nested in the
+    //checkpoints still alive (O(1))
+    mark_t mark(void);
+
+    //rewinds the union-find data structure back to the checkpoint m,
+    //that stays alive while the checkpoints nested in m are released
+    //(O(k) for k operations since m)
+    void rollback_to(const mark_t& m);
+
+    //releases the checkpoint m and the checkpoints nested in m without
+    //undoing the operations since m. When no checkpoint remains, the
+    //log is discarded : the current state becomes the oldest state
+    //that can be rewinded to (O(1))
+    void commit(const mark_t& m);
   
   };//end template t_union_find
 
   //Implementation
 
-  template <bool WITH_REWIND>
-  t_union_find<WITH_REWIND>::t_union_find(void)
-    : m_parents(),
-      m_ranks(),
-      m_nb_cc(0)
+  template <bool WITH_REWIND, class... _policies>
+  t_union_find<WITH_REWIND, _policies...>::t_union_find(void)
+    : m_storage(),
+      m_members(),
+      m_aggregates(),
+      m_removals(),
+      m_stats(),
+      m_nb_cc(0),
+      m_operations(),
+      m_marks()
   {
   }
 
-  template <bool WITH_REWIND>
-  bool t_union_find<WITH_REWIND>::is_valid(vertex_t u)const
+  template <bool WITH_REWIND, class... _policies>
+  bool t_union_find<WITH_REWIND, _policies...>::is_valid(vertex_t u)const
   {
     return u < this->size();
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::record_make_set(vertex_t u)
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::leader(vertex_t u)const
   {
-    if(WITH_REWIND)
-      this->m_operations.push(operation_entry_t(MAKE_SET, u, u, true));
+    while(u != this->m_storage.parent(u))
+      u = this->m_storage.parent(u);
+    return u;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::leaders_window(vertex_t* vertices, std::size_t n)const
+  {
+    //FIND_WINDOW walks are in flight : each round moves every walk one
+    //parent up, and a finished walk writes its leader in place and
+    //starts on the next vertex, so that no walk waits for the others
+    const vertex_t* parents = this->m_storage.parents_data();
+    vertex_t current[FIND_WINDOW];
+    std::size_t position[FIND_WINDOW];
+    std::size_t next = 0, active = 0;
+    for(; active < FIND_WINDOW && next < n; active++, next++)
+      {
+	assert(this->is_valid(vertices[next]));
+	current[active] = vertices[next];
+	position[active] = next;
+	prefetch(parents + current[active]);
+      }
+
+    while(active > 0)
+      for(std::size_t j = 0; j < active; )
+	{
+	  vertex_t p = this->m_storage.parent(current[j]);
+	  if(p != current[j])
+	    {
+	      current[j] = p;
+	      prefetch(parents + p);
+	      j++;
+	    }
+	  else
+	    {
+	      vertices[position[j]] = p;
+	      if(next < n)
+		{
+		  assert(this->is_valid(vertices[next]));
+		  current[j] = vertices[next];
+		  position[j] = next++;
+		  prefetch(parents + current[j]);
+		  j++;
+		}
+	      else
+		{
+		  active--;
+		  current[j] = current[active];
+		  position[j] = position[active];
+		}
+	    }
+	}
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::record_find_set(vertex_t u, vertex_t v)
+  template <bool WITH_REWIND, class... _policies>
+  t_union_find_file_header t_union_find<WITH_REWIND, _policies...>::file_header(std::size_t size, std::size_t nb_cc, std::size_t log_words)
+  {
+    t_union_find_file_header header;
+    header.vertex_bytes = sizeof(vertex_t);
+    header.weight_bytes = (linking_t::USES_WEIGHT && !storage_t::WEIGHTS_IN_PARENTS) ? sizeof(weight_t) : 0;
+    header.linking = linking_t::FILE_ID;
+    header.flags = (storage_t::WEIGHTS_IN_PARENTS ? t_union_find_file_header::WEIGHTS_IN_PARENTS : 0)
+      | (members_t::ENABLED ? t_union_find_file_header::MEMBER_LISTS : 0)
+      | (log_words > 0 ? t_union_find_file_header::REWIND_LOG : 0);
+    header.size = size;
+    header.nb_cc = nb_cc;
+    header.log_words = log_words;
+    return header;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::record_make_set(void)
   {
     if(WITH_REWIND)
-      this->m_operations.push(operation_entry_t(FIND_SET, u, v, false));  
+      {
+	this->m_operations.push(MAKE_SET, true);
+	this->m_stats.log(this->m_operations.size());
+      }
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::record_union_sets(vertex_t u, vertex_t v, bool increased_rank)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::release_set(vertex_t u)
   {
+    //the vertices are collected before any of them is unlinked, the
+    //finds going through the tombstones
+    std::vector<vertex_t> vertices;
+    if(members_t::ENABLED)
+      {
+	vertex_t v = u;
+	do
+	  {
+	    vertices.push_back(v);
+	    v = this->m_members.next(v);
+	  }
+	while(v != u);
+      }
+    else
+      for(vertex_t v = 0; v < this->size(); v++)
+	if(!this->m_removals.released(v) && u == this->find_set(v))
+	  vertices.push_back(v);
+
+    for(vertex_t v : vertices)
+      {
+	this->m_storage.make_root(v, linking_t::template initial_weight<weight_t>());
+	this->m_members.make_singleton(v);
+	this->m_removals.release(v);
+      }
+    this->m_nb_cc--;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::record_union_sets(vertex_t u, vertex_t v, bool increased_rank, weight_t weight)
+  {
+    //the weight of v is only needed if stored in its parent
     if(WITH_REWIND)
-      this->m_operations.push(operation_entry_t(UNION_SETS, u, v, increased_rank));    
+      {
+	if(storage_t::WEIGHTS_IN_PARENTS)
+	  this->m_operations.push(UNION_SETS, increased_rank, u, v, vertex_t(weight));
+	else
+	  this->m_operations.push(UNION_SETS, increased_rank, u, v);
+	this->m_stats.log(this->m_operations.size());
+      }
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::clear(void)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::clear(void)
   {
-    this->m_parents.clear();
-    this->m_ranks.clear();
-    while(!this->m_operations.empty())
-      this->m_operations.pop();
+    this->m_storage.clear();
+    this->m_members.clear();
+    this->m_aggregates.clear();
+    this->m_removals.clear();
+    this->m_operations.clear();
+    this->m_marks.clear();
     this->m_nb_cc = 0;
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::reset(void)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::reset(void)
   {
     this->m_nb_cc = this->size();
-    while(!this->m_operations.empty())
-      this->m_operations.pop();
-    for(vertex_t u = 0; u < this->size(); u++)
+    this->m_operations.clear();
+    this->m_marks.clear();
+    this->m_storage.reset(linking_t::template initial_weight<weight_t>());
+    if(members_t::ENABLED)
+      for(vertex_t u = 0; u < this->size(); u++)
+	this->m_members.make_singleton(u);
+    this->m_aggregates.reset();
+    this->m_removals.reset();
+    //with Rewind, the vertices can be removed again
+    for(std::size_t i = 0; WITH_REWIND && i < this->size(); i++)
+      this->record_make_set();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::make_set(void)
+  {
+    if(this->m_removals.number_of_free() > 0)
       {
-	this->m_parents[u] = u;
-	this->m_ranks[u] = 0;
-	this->m_operations.push(operation_entry_t(MAKE_SET, u, u, true));
+	vertex_t u = this->m_removals.recycle();
+	this->m_storage.make_root(u, linking_t::template initial_weight<weight_t>());
+	this->m_members.make_singleton(u);
+	this->m_stats.make_sets(1);
+	this->m_nb_cc++;
+	return u;
       }
+
+    assert(this->size() < storage_t::max_size());
+
+    vertex_t u = vertex_t(this->size());
+    this->m_storage.push_back(linking_t::template initial_weight<weight_t>());
+    this->m_members.push_back(u);
+    this->m_aggregates.push_back(aggregate_t());
+    this->m_removals.push_back();
+    this->m_stats.make_sets(1);
+    this->m_nb_cc++;
+    this->record_make_set();
+    return u;
   }
 
-  template <bool WITH_REWIND>
-  typename t_union_find<WITH_REWIND>::vertex_t t_union_find<WITH_REWIND>::make_set(void)
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::make_set(const aggregate_t& value)
   {
-    vertex_t u = this->size();
-    this->m_parents.push_back(u);
-    this->m_ranks.push_back(0);
-    this->m_nb_cc++;
-    this->record_make_set(u);
+    static_assert(aggregates_t::ENABLED, "make_set(value) needs an aggregate policy");
+
+    vertex_t u = this->make_set();
+    this->m_aggregates.pop_back();
+    this->m_aggregates.push_back(value);
     return u;
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::make_sets(std::size_t n)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::make_sets(std::size_t n)
   {
-    //first allocate the memory to avoid reserving too much space
-    this->m_parents.reserve(this->size() + n);
-    this->m_ranks.reserve(this->size() + n);
-    for(std::size_t i = 0; i < n; i++)
+    for(; n > 0 && this->m_removals.number_of_free() > 0; n--)
       this->make_set();
+
+    assert(this->size() + n <= storage_t::max_size());
+
+    this->m_storage.grow(n, linking_t::template initial_weight<weight_t>());
+    this->m_members.grow(n);
+    this->m_aggregates.grow(n);
+    this->m_removals.grow(n);
+    this->m_stats.make_sets(n);
+    this->m_nb_cc += n;
+    for(std::size_t i = 0; WITH_REWIND && i < n; i++)
+      this->record_make_set();
   }
 
-  template <bool WITH_REWIND>
-  typename t_union_find<WITH_REWIND>::vertex_t t_union_find<WITH_REWIND>::find_set(vertex_t u)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::reserve(std::size_t n)
+  {
+    assert(n <= storage_t::max_size());
+
+    this->m_storage.reserve(n);
+    this->m_members.reserve(n);
+    this->m_aggregates.reserve(n);
+    this->m_removals.reserve(n);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::find_set(vertex_t u)
   {
     assert(this->is_valid(u));
-  
-    if(this->m_parents[u] != u)
+
+    //the statistics are empty calls without t_stats
+    vertex_t start = u;
+    std::size_t length = 0;
+    std::size_t writes = this->m_stats.parent_writes(this->m_storage);
+    if(!WITH_REWIND)
+      u = compression_t::find(this->m_storage, u, [&length](vertex_t){
+	  if(stats_t::ENABLED)
+	    length++;
+	});
+    else
       {
-	this->record_find_set(u, this->m_parents[u]);
-	this->m_parents[u] = this->find_set(this->m_parents[u]);
+	//the whole path is recorded in one entry of the log
+	operations_t& operations = this->m_operations;
+	operations.begin_path();
+	u = compression_t::find(this->m_storage, u, [&operations, &length](vertex_t w){
+	    operations.push_path(w);
+	    if(stats_t::ENABLED)
+	      length++;
+	  });
+	operations.end_path();
+	this->m_stats.log(operations.size());
       }
-
-    return this->m_parents[u];
+    //t_no_compression visits nothing, its path is still there
+    if(stats_t::ENABLED && std::is_same<compression_t, t_no_compression>::value)
+      for(vertex_t w = start; w != u; w = this->m_storage.parent(w))
+	length++;
+    this->m_stats.find(length, this->m_stats.parent_writes(this->m_storage) - writes);
+    return u;
   }
 
-  template <bool WITH_REWIND>
-  typename t_union_find<WITH_REWIND>::vertex_t t_union_find<WITH_REWIND>::union_sets(vertex_t u, vertex_t v)
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::union_sets(vertex_t u, vertex_t v)
   {
     assert(this->is_valid(u));
     assert(this->is_valid(v));
+    assert(!this->m_removals.removed(u));
+    assert(!this->m_removals.removed(v));
 
     //Find the leaders of each set
     u = this->find_set(u);
     v = this->find_set(v);
+    this->m_stats.union_sets(u != v);
 
-    //If not the same set, the new leader is the one with the highest
-    //rank.
+    //If not the same set, the new leader is chosen by the linking
+    //policy.
     if(u != v)
       {
 	this->m_nb_cc--;
-	if(this->m_ranks[u] < this->m_ranks[v])
+	bool changed;
+	vertex_t leader = linking_t::link(this->m_storage, u, v, changed);
+	if(leader != u)
+	  std::swap(u, v);
+	//the weight of v is overwritten if stored in its parent
+	this->record_union_sets(u, v, changed, this->m_storage.weight(v));
+	this->m_storage.set_parent(v, u);
+	this->m_members.link(u, v);
+	this->m_aggregates.link(u, v, WITH_REWIND);
+	this->m_removals.link(u, v);
+      }
+
+    //In any case, the parent of any previous leader is the leader of
+    //the new set.
+    return this->m_storage.parent(v);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  template<class _random_access_iterator>
+  void t_union_find<WITH_REWIND, _policies...>::union_batch(_random_access_iterator first, _random_access_iterator last, unsigned nb_threads)
+  {
+    //sampling period of the first pass
+    const std::size_t SAMPLING = 16;
+
+    std::size_t m = std::distance(first, last);
+    nb_threads = number_of_threads(nb_threads);
+
+    //Going through the concurrent structure costs O(n), which is not
+    //worth it for one thread or few edges.
+    if(nb_threads == 1 || m < this->size())
+      {
+	for(; first != last; ++first)
+	  this->union_sets(std::get<0>(*first), std::get<1>(*first));
+	return;
+      }
+
+    //Copy the current partition in a concurrent structure.
+    t_concurrent_union_find uf(this->size());
+    if(this->number_of_independent_sets() < this->size())
+      for(vertex_t u = 0; u < this->size(); u++)
+	uf.union_sets(u, this->find_set(u));
+
+    //First pass on a sample of the edges, that is enough to build the
+    //large sets of the partition.
+    parallel_for((m + SAMPLING - 1) / SAMPLING, nb_threads, [&uf, first](std::size_t i){
+	const typename std::iterator_traits<_random_access_iterator>::value_type& e = first[i * SAMPLING];
+	uf.union_sets(std::get<0>(e), std::get<1>(e));
+      });
+
+    //Flatten the trees so that the second pass mostly finds both
+    //vertices of an edge directly below the same leader.
+    parallel_for(this->size(), nb_threads, [&uf](std::size_t u){
+	uf.find_set(u);
+      });
+
+    //Second pass on the remaining edges.
+    parallel_for(m, nb_threads, [&uf, first](std::size_t i){
+	if(i % SAMPLING != 0)
 	  {
-	    this->m_parents[u] = v;
-	    this->record_union_sets(v, u, false);
+	    const typename std::iterator_traits<_random_access_iterator>::value_type& e = first[i];
+	    uf.union_sets(std::get<0>(e), std::get<1>(e));
 	  }
-	else
+      });
+
+    //Merge the sets found back in this structure, each recorded union
+    //being one merge of the batch.
+    std::vector<vertex_t> leaders(this->size());
+    parallel_for(this->size(), nb_threads, [&uf, &leaders](std::size_t u){
+	leaders[u] = uf.find_set(u);
+      });
+    for(vertex_t u = 0; u < this->size(); u++)
+      if(leaders[u] != u)
+	this->union_sets(leaders[u], u);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  template<class _edges>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::connected_components(const _edges& edges, unsigned nb_threads)
+  {
+    this->union_batch(std::begin(edges), std::end(edges), nb_threads);
+    return this->number_of_independent_sets();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  const std::size_t t_union_find<WITH_REWIND, _policies...>::FIND_WINDOW;
+
+  template <bool WITH_REWIND, class... _policies>
+  const std::size_t t_union_find<WITH_REWIND, _policies...>::FIND_BUFFER;
+
+  template <bool WITH_REWIND, class... _policies>
+  template<class _input_iterator, class _output_iterator>
+  _output_iterator t_union_find<WITH_REWIND, _policies...>::find_batch(_input_iterator first, _input_iterator last, _output_iterator out)const
+  {
+    vertex_t window[FIND_BUFFER];
+    while(first != last)
+      {
+	std::size_t n = 0;
+	for(; n < FIND_BUFFER && first != last; ++first)
+	  window[n++] = vertex_t(*first);
+	this->leaders_window(window, n);
+	for(std::size_t i = 0; i < n; i++)
+	  *out++ = window[i];
+      }
+    return out;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  template<class _input_iterator, class _output_iterator>
+  _output_iterator t_union_find<WITH_REWIND, _policies...>::same_set_batch(_input_iterator first, _input_iterator last, _output_iterator out)const
+  {
+    vertex_t window[FIND_BUFFER];
+    while(first != last)
+      {
+	std::size_t n = 0;
+	for(; n < FIND_BUFFER && first != last; ++first)
 	  {
-	    //If ranks are equal, the leader of u becomes the new leader.
-	    if(!(this->m_ranks[v] < this->m_ranks[u]))
-	      {
-		this->m_ranks[u]++;
-		this->record_union_sets(u, v, true);
-	      }
-	    else
-	      this->record_union_sets(u, v, false);
-	    
-	    this->m_parents[v] = u;
+	    window[n++] = vertex_t(std::get<0>(*first));
+	    window[n++] = vertex_t(std::get<1>(*first));
 	  }
+	this->leaders_window(window, n);
+	for(std::size_t i = 0; i < n; i += 2)
+	  *out++ = window[i] == window[i + 1];
       }
+    return out;
+  }
 
-    //In any case, the parent of any previous leader is the leader of
-    //the new set.
-    return this->m_parents[v];
+  template <bool WITH_REWIND, class... _policies>
+  bool t_union_find<WITH_REWIND, _policies...>::empty(void)const
+  {
+    return this->size() == 0;
   }
 
-  template <bool WITH_REWIND>
-  bool t_union_find<WITH_REWIND>::empty(void)const
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::size(void)const
   {
-    return this->m_parents.empty();
+    return this->m_storage.size();
   }
 
-  template <bool WITH_REWIND>
-  std::size_t t_union_find<WITH_REWIND>::size(void)const
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::max_size(void)
   {
-    return this->m_parents.size();
+    return storage_t::max_size();
   }
 
-  template <bool WITH_REWIND>
-  std::size_t t_union_find<WITH_REWIND>::number_of_independent_sets(void)const
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::number_of_independent_sets(void)const
   {
     return this->m_nb_cc;
   }
 
-  template <bool WITH_REWIND>
+  template <bool WITH_REWIND, class... _policies>
   template<class _output_iterator>
-  _output_iterator t_union_find<WITH_REWIND>::leaders(_output_iterator out)
+  _output_iterator t_union_find<WITH_REWIND, _policies...>::leaders(_output_iterator out)
   {
+    if(!removals_t::ENABLED)
+      {
+	for(vertex_t u = 0; u < this->size(); u++)
+	  if(u == this->find_set(u))
+	    *out = u;
+	return out;
+      }
+
+    //a removed leader is replaced by the first vertex alive of its set
+    std::vector<bool> reported(this->size(), false);
     for(vertex_t u = 0; u < this->size(); u++)
-      if(u == this->find_set(u))
-	*out = u;
+      if(!this->m_removals.removed(u))
+	{
+	  vertex_t leader = this->find_set(u);
+	  if(!reported[leader])
+	    {
+	      reported[leader] = true;
+	      *out = this->m_removals.removed(leader) ? u : leader;
+	    }
+	}
     return out;
   }
 
-  template <bool WITH_REWIND>
+  template <bool WITH_REWIND, class... _policies>
   template<class _output_iterator>
-  _output_iterator t_union_find<WITH_REWIND>::independent_set(vertex_t u, _output_iterator out)
+  _output_iterator t_union_find<WITH_REWIND, _policies...>::independent_set(vertex_t u, _output_iterator out)
   {
     assert(this->is_valid(u));
+
+    //walk the circular member list
+    if(members_t::ENABLED)
+      {
+	vertex_t v = u;
+	do
+	  {
+	    if(!this->m_removals.removed(v))
+	      *out = v;
+	    v = this->m_members.next(v);
+	  }
+	while(v != u);
+	return out;
+      }
   
     u = this->find_set(u);
     for(vertex_t v = 0; v < this->size(); v++)
-      if(u == this->find_set(v))
+      if(!this->m_removals.removed(v) && u == this->find_set(v))
 	*out = v;
     return out;
   }
 
-  template <bool WITH_REWIND>
-  typename t_union_find<WITH_REWIND>::operation_t t_union_find<WITH_REWIND>::rewind(void)
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::set_size(vertex_t u)
+  {
+    assert(this->is_valid(u));
+
+    u = this->find_set(u);
+    if(removals_t::ENABLED)
+      return this->m_removals.alive(u);
+    if(members_t::ENABLED)
+      return this->m_members.size(u);
+    if(std::is_same<linking_t, t_link_by_size>::value)
+      return std::size_t(this->m_storage.weight(u));
+
+    std::size_t size = 0;
+    for(vertex_t v = 0; v < this->size(); v++)
+      if(u == this->find_set(v))
+	size++;
+    return size;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::reserve_log(std::size_t n)
+  {
+    if(WITH_REWIND)
+      this->m_operations.reserve(n);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::log_size(void)const
+  {
+    return this->m_operations.size();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::log_memory(void)const
+  {
+    return this->m_operations.memory();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  const typename t_union_find<WITH_REWIND, _policies...>::aggregate_t& t_union_find<WITH_REWIND, _policies...>::aggregate(vertex_t u)
+  {
+    static_assert(aggregates_t::ENABLED, "aggregate(u) needs an aggregate policy");
+
+    return this->m_aggregates.value(this->find_set(u));
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  t_frozen_union_find<typename t_union_find<WITH_REWIND, _policies...>::vertex_t> t_union_find<WITH_REWIND, _policies...>::freeze(unsigned nb_threads)const
+  {
+    return t_frozen_union_find<vertex_t>(this->size(), [this](vertex_t u){
+	return this->m_removals.removed(u) ? t_frozen_union_find<vertex_t>::ABSENT : this->leader(u);
+      }, nb_threads);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  const typename t_union_find<WITH_REWIND, _policies...>::vertex_t t_union_find<WITH_REWIND, _policies...>::REMOVED = std::numeric_limits<vertex_t>::max();
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::remove_vertex(vertex_t u)
+  {
+    static_assert(removals_t::ENABLED, "remove_vertex(u) needs t_free_list");
+    assert(this->is_valid(u));
+    assert(!this->m_removals.removed(u));
+
+    vertex_t leader = this->find_set(u);
+    if(this->m_removals.remove(u, leader) == 0)
+      this->release_set(leader);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::remove_set(vertex_t u)
+  {
+    static_assert(removals_t::ENABLED, "remove_set(u) needs t_free_list");
+    assert(this->is_valid(u));
+    assert(!this->m_removals.released(u));
+
+    this->release_set(this->find_set(u));
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  bool t_union_find<WITH_REWIND, _policies...>::is_removed(vertex_t u)const
+  {
+    assert(this->is_valid(u));
+
+    return this->m_removals.removed(u);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  std::size_t t_union_find<WITH_REWIND, _policies...>::number_of_free_vertices(void)const
+  {
+    return this->m_removals.number_of_free();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  std::vector<typename t_union_find<WITH_REWIND, _policies...>::vertex_t> t_union_find<WITH_REWIND, _policies...>::compact(void)
+  {
+    static_assert(removals_t::ENABLED, "compact() needs t_free_list");
+
+    //new index of each vertex alive, and of the first vertex alive of
+    //each set, to which the other vertices of the set are linked
+    std::size_t n = this->size();
+    std::vector<vertex_t> indices(n, REMOVED);
+    std::vector<vertex_t> firsts(n, REMOVED);
+    std::vector<vertex_t> targets;
+    vertex_t k = 0;
+    for(vertex_t u = 0; u < n; u++)
+      if(!this->m_removals.removed(u))
+	{
+	  vertex_t leader = this->find_set(u);
+	  if(firsts[leader] == REMOVED)
+	    firsts[leader] = k;
+	  targets.push_back(firsts[leader]);
+	  indices[u] = k++;
+	}
+
+    //the arrays are rebuilt in place, keeping their capacity; the
+    //rebuild is not counted by the statistics (there is no log to
+    //rewrite, since t_free_list excludes the Rewind feature)
+    stats_t stats = this->m_stats;
+    this->clear();
+    this->make_sets(k);
+    for(vertex_t u = 0; u < k; u++)
+      if(targets[u] != u)
+	this->union_sets(targets[u], u);
+    this->m_stats = stats;
+    return indices;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  t_union_find_stats t_union_find<WITH_REWIND, _policies...>::stats(void)const
+  {
+    static_assert(stats_t::ENABLED, "stats() needs t_stats");
+
+    t_union_find_stats stats = this->m_stats.stats();
+    stats.log_words = this->log_size();
+    stats.log_bytes = this->log_memory();
+    if(linking_t::USES_WEIGHT)
+      for(vertex_t u = 0; u < this->size(); u++)
+	if(!this->m_removals.released(u) && this->m_storage.parent(u) == u)
+	  {
+	    std::size_t w = std::size_t(this->m_storage.weight(u));
+	    if(std::is_same<linking_t, t_link_by_size>::value)
+	      w = t_union_find_stats::bucket(w);
+	    stats.weights[std::min<std::size_t>(w, t_union_find_stats::NB_BUCKETS - 1)]++;
+	  }
+    return stats;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::reset_stats(void)
+  {
+    this->m_stats.clear();
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::operation_t t_union_find<WITH_REWIND, _policies...>::rewind(void)
   {
     assert(WITH_REWIND);
   
-    if(!WITH_REWIND || this->empty())
+    if(!WITH_REWIND || this->empty() || this->m_operations.empty())
       return NONE;
   
-    operation_entry_t entry = this->m_operations.top();
-    switch(entry.operation)
+    typename operations_t::entry_t entry = this->m_operations.back();
+    operation_t operation = operation_t(entry.tag);
+    switch(operation)
       {
       case MAKE_SET   :
-	this->m_parents.pop_back();
-	this->m_ranks.pop_back();
+	this->m_storage.pop_back();
+	this->m_members.pop_back();
+	this->m_aggregates.pop_back();
 	this->m_nb_cc--;
 	break;
       case FIND_SET   :
-	this->m_parents[entry.u] = entry.v;
+	//restores the path followed by the find
+	for(std::size_t i = 0; i + 1 < entry.length; i++)
+	  this->m_storage.set_parent(entry.operands[i], entry.operands[i + 1]);
 	break;
       case UNION_SETS :
-	this->m_parents[entry.v] = entry.v;
-	this->m_nb_cc++;
-	if(entry.increased_rank)
-	  this->m_ranks[entry.u]--;
+	{
+	  vertex_t u = entry.operands[0];
+	  vertex_t v = entry.operands[1];
+	  if(storage_t::WEIGHTS_IN_PARENTS)
+	    this->m_storage.make_root(v, weight_t(entry.operands[2]));
+	  else
+	    this->m_storage.make_root(v, this->m_storage.weight(v));
+	  this->m_nb_cc++;
+	  linking_t::unlink(this->m_storage, u, v, entry.flag);
+	  this->m_members.unlink(u, v);
+	  this->m_aggregates.unlink(u);
+	}
 	break;
       case NONE:
 	break;
       }
 
-    this->m_operations.pop();
-    return entry.operation;
+    this->m_operations.pop_back();
+    this->m_stats.rewind();
+    return operation;
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::rewind(vertex_t u)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::rewind(vertex_t u)
   {
     assert(WITH_REWIND);
   
     if(WITH_REWIND)
       while(u < this->size())
-	this->rewind();
+	if(this->rewind() == NONE)
+	  return;
   }
 
-  template <bool WITH_REWIND>
-  void t_union_find<WITH_REWIND>::rewind(vertex_t u, vertex_t v)
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::rewind(vertex_t u, vertex_t v)
   {
     assert(WITH_REWIND);
   
@@ -393,24 +1124,134 @@ namespace utils{
       return;
   
     //make a manual find set to avoid path compression
-    vertex_t lu = u;
-    vertex_t lv = v;
-    while(lu != this->m_parents[lu])
-      lu = this->m_parents[lu];
-    while(lv != this->m_parents[lv])
-      lv = this->m_parents[lv];
+    vertex_t lu = this->leader(u);
+    vertex_t lv = this->leader(v);
 
+    //only the rewind of a union can separate u and v
     while(lu == lv)
       {
-	rewind();
+	operation_t operation = this->rewind();
+	if(operation == NONE)
+	  return;
+	if(operation != UNION_SETS)
+	  continue;
 
 	//research the new leaders of u and v
-	lu = u;
-	lv = v;
-	while(lu != this->m_parents[lu])
-	  lu = this->m_parents[lu];
-	while(lv != this->m_parents[lv])
-	  lv = this->m_parents[lv];
+	lu = this->leader(u);
+	lv = this->leader(v);
+      }
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  bool t_union_find<WITH_REWIND, _policies...>::save(const char* path, bool with_log)const
+  {
+    static_assert(!aggregates_t::ENABLED, "the aggregates are not saved");
+    static_assert(!removals_t::ENABLED, "the removed vertices are not saved");
+
+    std::size_t log_words = (WITH_REWIND && with_log) ? this->m_operations.size() : 0;
+    t_union_find_file_header header = file_header(this->size(), this->m_nb_cc, log_words);
+
+    std::FILE* file = std::fopen(path, "wb");
+    if(file == nullptr)
+      return false;
+    this->m_storage.materialize();
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+      && write_union_find_section(file, header.parents_offset(), this->m_storage.parents_data(), header.size * header.vertex_bytes)
+      && write_union_find_section(file, header.weights_offset(), this->m_storage.weights_data(), header.size * header.weight_bytes);
+    if(ok && members_t::ENABLED)
+      ok = write_union_find_section(file, header.members_offset(), this->m_members.next_data(), header.size * header.vertex_bytes)
+	&& write_union_find_section(file, header.members_offset() + header.size * header.vertex_bytes, this->m_members.sizes_data(), header.size * header.vertex_bytes);
+    if(ok)
+      ok = write_union_find_section(file, header.log_offset(), nullptr, 0)
+	&& (log_words == 0 || this->m_operations.write(file));
+    return std::fclose(file) == 0 && ok;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  bool t_union_find<WITH_REWIND, _policies...>::load(const char* path)
+  {
+    static_assert(!aggregates_t::ENABLED, "the aggregates are not saved");
+    static_assert(!removals_t::ENABLED, "the removed vertices are not saved");
+
+    this->clear();
+
+    std::FILE* file = std::fopen(path, "rb");
+    if(file == nullptr)
+      return false;
+    //the sections are checked against the length of the file before
+    //any allocation
+    t_union_find_file_header header;
+    long length = -1;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+      && header.same_layout(file_header(0, 0, 0))
+      && std::fseek(file, 0, SEEK_END) == 0
+      && (length = std::ftell(file)) >= 0
+      && header.fits(std::uint64_t(length))
+      && header.size <= storage_t::max_size();
+    if(ok)
+      {
+	this->m_storage.resize(header.size);
+	this->m_members.resize(header.size);
+	ok = read_union_find_section(file, header.parents_offset(), this->m_storage.parents_data(), header.size * header.vertex_bytes)
+	  && read_union_find_section(file, header.weights_offset(), this->m_storage.weights_data(), header.size * header.weight_bytes);
+      }
+    if(ok && members_t::ENABLED)
+      ok = read_union_find_section(file, header.members_offset(), this->m_members.next_data(), header.size * header.vertex_bytes)
+	&& read_union_find_section(file, header.members_offset() + header.size * header.vertex_bytes, this->m_members.sizes_data(), header.size * header.vertex_bytes);
+    if(ok && WITH_REWIND && header.log_words > 0)
+      ok = std::fseek(file, long(header.log_offset()), SEEK_SET) == 0
+	&& this->m_operations.read(file, header.log_words);
+    std::fclose(file);
+
+    //the finds and the walks of the member lists must stay in the
+    //structure
+    const storage_t& storage = this->m_storage;
+    if(ok)
+      ok = valid_union_find_forest(std::size_t(header.size), std::size_t(header.nb_cc), [&storage](std::size_t u){return storage.parent(vertex_t(u));});
+    if(ok && members_t::ENABLED)
+      ok = valid_union_find_members(std::size_t(header.size), this->m_members.next_data(), this->m_members.sizes_data());
+
+    if(!ok)
+      {
+	this->clear();
+	return false;
+      }
+    this->m_nb_cc = header.nb_cc;
+    return true;
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  typename t_union_find<WITH_REWIND, _policies...>::mark_t t_union_find<WITH_REWIND, _policies...>::mark(void)
+  {
+    assert(WITH_REWIND);
+
+    this->m_marks.push_back(this->m_operations.size());
+    return mark_t(this->m_operations.size(), this->m_marks.size() - 1);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::rollback_to(const mark_t& m)
+  {
+    assert(WITH_REWIND);
+    assert(m.m_depth < this->m_marks.size() && this->m_marks[m.m_depth] == m.m_position);
+    assert(m.m_position <= this->m_operations.size());
+
+    while(m.m_position < this->m_operations.size())
+      this->rewind();
+    this->m_marks.resize(m.m_depth + 1);
+  }
+
+  template <bool WITH_REWIND, class... _policies>
+  void t_union_find<WITH_REWIND, _policies...>::commit(const mark_t& m)
+  {
+    assert(WITH_REWIND);
+    assert(m.m_depth < this->m_marks.size() && this->m_marks[m.m_depth] == m.m_position);
+
+    this->m_marks.resize(m.m_depth);
+    if(this->m_marks.empty())
+      {
+	this->m_operations.clear();
+	this->m_aggregates.clear_log();
       }
   }
 
@@ -0,0 +1,176 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_ALLOCATOR_HPP_
+#define _UTILS_UNION_FIND_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace utils{
+  /*
+    Vector of _value allocated by _allocator rebound to _value, for
+    the arrays of the storages and of the policies (see t_allocator).
+  */
+
+  template <class _value, class _allocator>
+  struct t_allocator_vector{
+    typedef std::vector<_value, typename std::allocator_traits<_allocator>::template rebind_alloc<_value> > type;
+  };
+
+  /*
+    Allocator backing the large arrays with huge pages, to cut the TLB
+    misses of the random accesses of the finds : one TLB entry covers
+    2MB instead of 4KB. The blocks of at least HUGE_PAGE_SIZE bytes are
+    mapped aligned on a huge page, and :
+    - with EXPLICIT false, marked for the transparent huge pages of
+      Linux (madvise), that the kernel uses when it can,
+    - with EXPLICIT true, taken from the reserved huge pages
+      (MAP_HUGETLB, see /proc/sys/vm/nr_hugepages), falling back to
+      the transparent huge pages when none is left.
+    The smaller blocks, and all of them on other systems, come from
+    the operator new. The allocator has no state, so that the blocks
+    are freed by any copy of it.
+  */
+
+  template <class _value, bool EXPLICIT = false>
+  class t_huge_page_allocator{
+
+    //Types
+
+  public:
+
+    typedef _value value_type;
+
+    template <class _other>
+    struct rebind{
+      typedef t_huge_page_allocator<_other, EXPLICIT> other;
+    };
+
+    static const std::size_t HUGE_PAGE_SIZE = std::size_t(1) << 21;
+
+    //Constructors
+
+  public:
+
+    t_huge_page_allocator(void){}
+
+    template <class _other>
+    t_huge_page_allocator(const t_huge_page_allocator<_other, EXPLICIT>&){}
+
+    //Internal
+
+  private:
+
+    //Size of the mapping of a block of n bytes, a multiple of the huge
+    //pages.
+    static std::size_t mapped_size(std::size_t n){return (n + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);}
+
+    //Maps size bytes aligned on a huge page, returns nullptr on failure.
+    static void* map(std::size_t size);
+
+    //Operations
+
+  public:
+
+    //allocates n values (O(1))
+    _value* allocate(std::size_t n);
+
+    //frees the block p of n values (O(1))
+    void deallocate(_value* p, std::size_t n);
+
+  };//end class t_huge_page_allocator
+
+  template <class _value1, class _value2, bool EXPLICIT>
+  bool operator==(const t_huge_page_allocator<_value1, EXPLICIT>&, const t_huge_page_allocator<_value2, EXPLICIT>&){return true;}
+
+  template <class _value1, class _value2, bool EXPLICIT>
+  bool operator!=(const t_huge_page_allocator<_value1, EXPLICIT>&, const t_huge_page_allocator<_value2, EXPLICIT>&){return false;}
+
+  //Implementation
+
+  template <class _value, bool EXPLICIT>
+  const std::size_t t_huge_page_allocator<_value, EXPLICIT>::HUGE_PAGE_SIZE;
+
+  template <class _value, bool EXPLICIT>
+  void* t_huge_page_allocator<_value, EXPLICIT>::map(std::size_t size)
+  {
+#if defined(__linux__)
+#if defined(MAP_HUGETLB)
+    if(EXPLICIT)
+      {
+	void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if(p != MAP_FAILED)
+	  return p;
+      }
+#endif
+    //an extra huge page is mapped, so that the block can start on a
+    //huge page boundary, and the two ends are unmapped
+    char* p = static_cast<char*>(::mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if(p == MAP_FAILED)
+      return nullptr;
+    std::size_t head = (HUGE_PAGE_SIZE - std::uintptr_t(p) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if(head > 0)
+      ::munmap(p, head);
+    ::munmap(p + head + size, HUGE_PAGE_SIZE - head);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(p + head, size, MADV_HUGEPAGE);
+#endif
+    return p + head;
+#else
+    (void)size;
+    return nullptr;
+#endif
+  }
+
+  template <class _value, bool EXPLICIT>
+  _value* t_huge_page_allocator<_value, EXPLICIT>::allocate(std::size_t n)
+  {
+    std::size_t bytes = n * sizeof(_value);
+#if defined(__linux__)
+    if(bytes >= HUGE_PAGE_SIZE)
+      {
+	void* p = map(mapped_size(bytes));
+	if(p == nullptr)
+	  throw std::bad_alloc();
+	return static_cast<_value*>(p);
+      }
+#endif
+    return static_cast<_value*>(::operator new(bytes));
+  }
+
+  template <class _value, bool EXPLICIT>
+  void t_huge_page_allocator<_value, EXPLICIT>::deallocate(_value* p, std::size_t n)
+  {
+    std::size_t bytes = n * sizeof(_value);
+#if defined(__linux__)
+    if(bytes >= HUGE_PAGE_SIZE)
+      {
+	::munmap(p, mapped_size(bytes));
+	return;
+      }
+#endif
+    ::operator delete(p);
+  }
+
+}//end namespace utils
+
+#endif
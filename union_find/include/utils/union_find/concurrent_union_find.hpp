@@ -0,0 +1,359 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_CONCURRENT_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_CONCURRENT_UNION_FIND_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace utils{
+  /*
+    A lock-free Union-Find for maintaining the independent sets of a
+    data collection from several threads at once.
+
+    Each vertex is represented by one atomic word packing its parent
+    (low bits) and its rank (high byte). The leaders are linked by
+    compare-and-swap on their word, ordering the leaders by (rank,
+    index) so that no cycle can be created whatever the interleaving
+    of the threads. The find operation uses path halving: each
+    shortcut is attempted once with a compare-and-swap and never
+    retried, so a find never waits on another thread.
+
+    The view t_atomic_union_find_view implements the operations on
+    words it does not own, so that the same algorithm can run on any
+    memory (heap, file or shared segment). The class
+    t_concurrent_union_find owns its words. Only find_set, union_sets
+    and same_set are safe to call concurrently; the other operations
+    must be called while no other thread uses the structure.
+  */
+
+  class t_atomic_union_find_view{
+
+    //Types
+
+  public:
+
+    typedef std::size_t   vertex_t;
+    typedef std::uint64_t word_t;
+
+  protected:
+
+    static const unsigned RANK_SHIFT  = 56;
+    static const word_t   PARENT_MASK = (word_t(1) << RANK_SHIFT) - 1;
+
+    //Attributes
+
+  protected:
+
+    std::atomic<word_t>*        m_words;
+    std::size_t                 m_size;
+    std::atomic<std::uint64_t>* m_nb_cc;
+
+    //Constructors
+
+  public:
+
+    t_atomic_union_find_view(void);
+
+    t_atomic_union_find_view(std::atomic<word_t>* words, std::size_t size, std::atomic<std::uint64_t>* nb_cc);
+
+    //Internal
+
+  protected:
+
+    static word_t make_word(vertex_t parent, word_t rank);
+
+    static vertex_t parent_of(word_t w);
+
+    static word_t rank_of(word_t w);
+
+    //Check that u is a vertex of this structure.
+    bool is_valid(vertex_t u)const;
+
+    //Base operations
+
+  public:
+
+    //does one independent set per vertex, not thread-safe (O(n))
+    void reset(void);
+
+    //finds the leader of the set containing u using path halving,
+    //thread-safe (~O(1))
+    vertex_t find_set(vertex_t u);
+
+    //unions two sets if they are disjoint, thread-safe (~O(1))
+    vertex_t union_sets(vertex_t u, vertex_t v);
+
+    //returns true iff u and v are in the same set, thread-safe (~O(1))
+    bool same_set(vertex_t u, vertex_t v);
+
+    //Independent sets
+
+  public:
+
+    //returns true iff there is no vertex in the structure (O(1))
+    bool empty(void)const;
+
+    //returns the number of vertices in the structure (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of independent sets in the structure, exact
+    //once the concurrent unions are done (O(1))
+    std::size_t number_of_independent_sets(void)const;
+
+    //fills the input container with all the leaders (O(n))
+    template<class _output_iterator>
+    _output_iterator leaders(_output_iterator out);
+
+    //fills the input container with all the vertices in the set
+    //containing u (O(n))
+    template<class _output_iterator>
+    _output_iterator independent_set(vertex_t u, _output_iterator out);
+
+  };//end class t_atomic_union_find_view
+
+  class t_concurrent_union_find : public t_atomic_union_find_view{
+
+    //Attributes
+
+  private:
+
+    std::unique_ptr<std::atomic<word_t>[]> m_storage;
+    std::atomic<std::uint64_t>             m_counter;
+
+    //Constructors
+
+  public:
+
+    explicit t_concurrent_union_find(std::size_t n = 0);
+
+    t_concurrent_union_find(const t_concurrent_union_find&) = delete;
+
+    t_concurrent_union_find& operator=(const t_concurrent_union_find&) = delete;
+
+    //Base operations
+
+  public:
+
+    //removes all vertices from the structure, not thread-safe (O(1))
+    void clear(void);
+
+    //adds n new vertices, not thread-safe (O(n))
+    void make_sets(std::size_t n);
+
+  };//end class t_concurrent_union_find
+
+  //Implementation
+
+  inline t_atomic_union_find_view::t_atomic_union_find_view(void)
+    : m_words(nullptr),
+      m_size(0),
+      m_nb_cc(nullptr)
+  {
+  }
+
+  inline t_atomic_union_find_view::t_atomic_union_find_view(std::atomic<word_t>* words, std::size_t size, std::atomic<std::uint64_t>* nb_cc)
+    : m_words(words),
+      m_size(size),
+      m_nb_cc(nb_cc)
+  {
+    assert(size <= PARENT_MASK);
+  }
+
+  inline t_atomic_union_find_view::word_t t_atomic_union_find_view::make_word(vertex_t parent, word_t rank)
+  {
+    return (rank << RANK_SHIFT) | word_t(parent);
+  }
+
+  inline t_atomic_union_find_view::vertex_t t_atomic_union_find_view::parent_of(word_t w)
+  {
+    return vertex_t(w & PARENT_MASK);
+  }
+
+  inline t_atomic_union_find_view::word_t t_atomic_union_find_view::rank_of(word_t w)
+  {
+    return w >> RANK_SHIFT;
+  }
+
+  inline bool t_atomic_union_find_view::is_valid(vertex_t u)const
+  {
+    return u < this->size();
+  }
+
+  inline void t_atomic_union_find_view::reset(void)
+  {
+    for(vertex_t u = 0; u < this->size(); u++)
+      this->m_words[u].store(make_word(u, 0), std::memory_order_relaxed);
+    if(this->m_nb_cc != nullptr)
+      this->m_nb_cc->store(this->size());
+  }
+
+  inline t_atomic_union_find_view::vertex_t t_atomic_union_find_view::find_set(vertex_t u)
+  {
+    assert(this->is_valid(u));
+
+    word_t wu = this->m_words[u].load(std::memory_order_acquire);
+    while(parent_of(wu) != u)
+      {
+	//path halving : u jumps to its grand parent, the shortcut is
+	//only attempted once since a failure means that another thread
+	//already moved u closer to its leader
+	vertex_t p = parent_of(wu);
+	vertex_t g = parent_of(this->m_words[p].load(std::memory_order_acquire));
+	if(g != p)
+	  this->m_words[u].compare_exchange_weak(wu, make_word(g, rank_of(wu)), std::memory_order_acq_rel, std::memory_order_relaxed);
+	u = g;
+	wu = this->m_words[u].load(std::memory_order_acquire);
+      }
+    return u;
+  }
+
+  inline t_atomic_union_find_view::vertex_t t_atomic_union_find_view::union_sets(vertex_t u, vertex_t v)
+  {
+    assert(this->is_valid(u));
+    assert(this->is_valid(v));
+
+    while(true)
+      {
+	u = this->find_set(u);
+	v = this->find_set(v);
+	if(u == v)
+	  return u;
+
+	//another thread may have linked u or v in between, then retry
+	word_t wu = this->m_words[u].load(std::memory_order_acquire);
+	word_t wv = this->m_words[v].load(std::memory_order_acquire);
+	if(parent_of(wu) != u || parent_of(wv) != v)
+	  continue;
+
+	//the new leader is the one with the highest (rank, index)
+	word_t ru = rank_of(wu);
+	word_t rv = rank_of(wv);
+	if(ru < rv || (ru == rv && u < v))
+	  {
+	    std::swap(u, v);
+	    std::swap(wu, wv);
+	    std::swap(ru, rv);
+	  }
+
+	//links v below u only if v is still a leader with the same rank
+	if(this->m_words[v].compare_exchange_strong(wv, make_word(u, rv), std::memory_order_acq_rel, std::memory_order_relaxed))
+	  {
+	    this->m_nb_cc->fetch_sub(1, std::memory_order_relaxed);
+	    //If ranks are equal, the rank of the new leader is increased,
+	    //unless another thread changed it meanwhile.
+	    if(ru == rv)
+	      this->m_words[u].compare_exchange_strong(wu, make_word(u, ru + 1), std::memory_order_acq_rel, std::memory_order_relaxed);
+	    return u;
+	  }
+      }
+  }
+
+  inline bool t_atomic_union_find_view::same_set(vertex_t u, vertex_t v)
+  {
+    assert(this->is_valid(u));
+    assert(this->is_valid(v));
+
+    while(true)
+      {
+	u = this->find_set(u);
+	v = this->find_set(v);
+	if(u == v)
+	  return true;
+	//u is still a leader, so u and v were disjoint at that time
+	if(parent_of(this->m_words[u].load(std::memory_order_acquire)) == u)
+	  return false;
+      }
+  }
+
+  inline bool t_atomic_union_find_view::empty(void)const
+  {
+    return this->m_size == 0;
+  }
+
+  inline std::size_t t_atomic_union_find_view::size(void)const
+  {
+    return this->m_size;
+  }
+
+  inline std::size_t t_atomic_union_find_view::number_of_independent_sets(void)const
+  {
+    return this->m_nb_cc == nullptr ? 0 : std::size_t(this->m_nb_cc->load());
+  }
+
+  template<class _output_iterator>
+  _output_iterator t_atomic_union_find_view::leaders(_output_iterator out)
+  {
+    for(vertex_t u = 0; u < this->size(); u++)
+      if(u == this->find_set(u))
+	*out = u;
+    return out;
+  }
+
+  template<class _output_iterator>
+  _output_iterator t_atomic_union_find_view::independent_set(vertex_t u, _output_iterator out)
+  {
+    assert(this->is_valid(u));
+
+    u = this->find_set(u);
+    for(vertex_t v = 0; v < this->size(); v++)
+      if(u == this->find_set(v))
+	*out = v;
+    return out;
+  }
+
+  inline t_concurrent_union_find::t_concurrent_union_find(std::size_t n)
+    : t_atomic_union_find_view(),
+      m_storage(),
+      m_counter(0)
+  {
+    this->m_nb_cc = &this->m_counter;
+    this->make_sets(n);
+  }
+
+  inline void t_concurrent_union_find::clear(void)
+  {
+    this->m_storage.reset();
+    this->m_words = nullptr;
+    this->m_size = 0;
+    this->m_counter.store(0);
+  }
+
+  inline void t_concurrent_union_find::make_sets(std::size_t n)
+  {
+    if(n == 0)
+      return;
+
+    std::size_t size = this->size() + n;
+    assert(size <= PARENT_MASK);
+    std::unique_ptr<std::atomic<word_t>[]> storage(new std::atomic<word_t>[size]);
+    for(vertex_t u = 0; u < this->size(); u++)
+      storage[u].store(this->m_words[u].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for(vertex_t u = this->size(); u < size; u++)
+      storage[u].store(make_word(u, 0), std::memory_order_relaxed);
+
+    this->m_storage.swap(storage);
+    this->m_words = this->m_storage.get();
+    this->m_size = size;
+    this->m_counter.fetch_add(n);
+  }
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,326 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_DYNAMIC_CONNECTIVITY_HPP_
+#define _UTILS_UNION_FIND_DYNAMIC_CONNECTIVITY_HPP_
+
+#include <cassert>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+#include <utils/union_find.hpp>
+
+namespace utils{
+  /*
+    Offline dynamic connectivity : answers connectivity queries on a
+    graph whose edges are added and removed over time, the whole
+    timeline of events being known before solving.
+
+    Each edge is alive during an interval of queries, which is split
+    on the O(log q) nodes of a segment tree over the queries. A depth
+    first traversal of the tree unions the edges of each node in a
+    t_union_find with Rewind, answers the query of each leaf, and
+    rolls the unions back when leaving a node. The union-find does no
+    path compression so that every operation is undone in O(1), and
+    links by rank so that a find is O(log n).
+
+    Solving costs O((m + q) log q log n) for m edge events and q
+    queries. An edge may be added several times : each removal ends
+    the most recent addition that is still alive.
+  */
+
+  template <class _vertex = std::size_t>
+  class t_dynamic_connectivity{
+
+    //Types
+
+  public:
+
+    typedef t_union_find<true, t_vertex_index<_vertex>, t_no_compression, t_link_by_rank> union_find_t;
+    typedef typename union_find_t::vertex_t                                               vertex_t;
+    typedef std::pair<vertex_t, vertex_t>                                                 edge_t;
+
+    enum event_t{
+      ADD_EDGE,
+      REMOVE_EDGE,
+      CONNECTED,//are u and v connected
+      COUNT//number of connected components
+    };
+
+  private:
+
+    struct t_event{
+      event_t  type;
+      vertex_t u;
+      vertex_t v;
+    };
+
+    //Attributes
+
+  private:
+
+    std::size_t                        m_size;//number of vertices
+    std::vector<t_event>               m_events;
+    std::size_t                        m_nb_queries;
+    std::vector<std::vector<edge_t> >  m_tree;//edges of each node of the segment tree
+    std::vector<std::size_t>           m_answers;
+    union_find_t                       m_uf;
+
+    //Constructors
+
+  public:
+
+    //a graph of n vertices and no edge
+    t_dynamic_connectivity(std::size_t n = 0);
+
+    //Internal
+
+  private:
+
+    static edge_t normalize(vertex_t u, vertex_t v);
+
+    //adds the edge to the nodes covering the queries [first, last)
+    void insert(std::size_t node, std::size_t l, std::size_t r, std::size_t first, std::size_t last, const edge_t& e);
+
+    //answers the queries of the subtree of node
+    void traverse(std::size_t node, std::size_t l, std::size_t r, const std::vector<std::size_t>& queries);
+
+    //Timeline
+
+  public:
+
+    //removes all the events (O(1))
+    void clear(void);
+
+    //returns the number of vertices (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of events (O(1))
+    std::size_t number_of_events(void)const;
+
+    //returns the number of queries (O(1))
+    std::size_t number_of_queries(void)const;
+
+    //appends the addition of the edge (u, v) (O(1))
+    void add_edge(vertex_t u, vertex_t v);
+
+    //appends the removal of the edge (u, v), that must be alive (O(1))
+    void remove_edge(vertex_t u, vertex_t v);
+
+    //appends the query "are u and v connected", returns its index
+    //(O(1))
+    std::size_t connected(vertex_t u, vertex_t v);
+
+    //appends the query "how many connected components", returns its
+    //index (O(1))
+    std::size_t count(void);
+
+    //Solving
+
+  public:
+
+    //answers all the queries of the timeline (O((m + q) log q log n))
+    void solve(void);
+
+    //returns the answer of the query i after solve : 0 or 1 for
+    //connected, the number of components for count (O(1))
+    std::size_t answer(std::size_t i)const;
+
+  };//end class t_dynamic_connectivity
+
+  //Implementation
+
+  template <class _vertex>
+  t_dynamic_connectivity<_vertex>::t_dynamic_connectivity(std::size_t n)
+    : m_size(n),
+      m_events(),
+      m_nb_queries(0),
+      m_tree(),
+      m_answers(),
+      m_uf()
+  {
+  }
+
+  template <class _vertex>
+  typename t_dynamic_connectivity<_vertex>::edge_t t_dynamic_connectivity<_vertex>::normalize(vertex_t u, vertex_t v)
+  {
+    return u < v ? edge_t(u, v) : edge_t(v, u);
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::clear(void)
+  {
+    this->m_events.clear();
+    this->m_nb_queries = 0;
+    this->m_answers.clear();
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::size(void)const
+  {
+    return this->m_size;
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::number_of_events(void)const
+  {
+    return this->m_events.size();
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::number_of_queries(void)const
+  {
+    return this->m_nb_queries;
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::add_edge(vertex_t u, vertex_t v)
+  {
+    assert(u < this->size() && v < this->size());
+    this->m_events.push_back(t_event{ADD_EDGE, u, v});
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::remove_edge(vertex_t u, vertex_t v)
+  {
+    assert(u < this->size() && v < this->size());
+    this->m_events.push_back(t_event{REMOVE_EDGE, u, v});
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::connected(vertex_t u, vertex_t v)
+  {
+    assert(u < this->size() && v < this->size());
+    this->m_events.push_back(t_event{CONNECTED, u, v});
+    return this->m_nb_queries++;
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::count(void)
+  {
+    this->m_events.push_back(t_event{COUNT, 0, 0});
+    return this->m_nb_queries++;
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::insert(std::size_t node, std::size_t l, std::size_t r, std::size_t first, std::size_t last, const edge_t& e)
+  {
+    if(first <= l && r <= last)
+      {
+	this->m_tree[node].push_back(e);
+	return;
+      }
+    std::size_t m = (l + r) / 2;
+    if(first < m)
+      this->insert(2 * node, l, m, first, last, e);
+    if(m < last)
+      this->insert(2 * node + 1, m, r, first, last, e);
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::traverse(std::size_t node, std::size_t l, std::size_t r, const std::vector<std::size_t>& queries)
+  {
+    typename union_find_t::mark_t m = this->m_uf.mark();
+    for(const edge_t& e : this->m_tree[node])
+      this->m_uf.union_sets(e.first, e.second);
+
+    if(r - l == 1)
+      {
+	const t_event& query = this->m_events[queries[l]];
+	if(query.type == CONNECTED)
+	  this->m_answers[l] = this->m_uf.find_set(query.u) == this->m_uf.find_set(query.v) ? 1 : 0;
+	else
+	  this->m_answers[l] = this->m_uf.number_of_independent_sets();
+      }
+    else
+      {
+	std::size_t mid = (l + r) / 2;
+	this->traverse(2 * node, l, mid, queries);
+	this->traverse(2 * node + 1, mid, r, queries);
+      }
+
+    this->m_uf.rollback_to(m);
+    this->m_uf.commit(m);
+  }
+
+  template <class _vertex>
+  void t_dynamic_connectivity<_vertex>::solve(void)
+  {
+    std::size_t q = this->m_nb_queries;
+    this->m_answers.assign(q, 0);
+    if(q == 0)
+      return;
+
+    //the events of the queries, and the interval of queries [first,
+    //last) of each addition
+    std::vector<std::size_t> queries;
+    queries.reserve(q);
+    std::vector<std::pair<edge_t, std::pair<std::size_t, std::size_t> > > intervals;
+    std::map<edge_t, std::vector<std::size_t> > alive;//first query of the alive additions of each edge
+    for(std::size_t i = 0; i < this->m_events.size(); i++)
+      {
+	const t_event& event = this->m_events[i];
+	edge_t e = normalize(event.u, event.v);
+	switch(event.type)
+	  {
+	  case ADD_EDGE :
+	    alive[e].push_back(queries.size());
+	    break;
+	  case REMOVE_EDGE :
+	    {
+	      typename std::map<edge_t, std::vector<std::size_t> >::iterator it = alive.find(e);
+	      assert(it != alive.end());
+	      if(it == alive.end())
+		break;
+	      intervals.push_back(std::make_pair(e, std::make_pair(it->second.back(), queries.size())));
+	      it->second.pop_back();
+	      if(it->second.empty())
+		alive.erase(it);
+	      break;
+	    }
+	  default :
+	    queries.push_back(i);
+	  }
+      }
+    for(const auto& edge : alive)
+      for(std::size_t first : edge.second)
+	intervals.push_back(std::make_pair(edge.first, std::make_pair(first, q)));
+
+    //segment tree over the queries
+    this->m_tree.assign(4 * q, std::vector<edge_t>());
+    for(const auto& interval : intervals)
+      if(interval.second.first < interval.second.second)
+	this->insert(1, 0, q, interval.second.first, interval.second.second, interval.first);
+
+    //the vertices are the oldest state of the union-find
+    this->m_uf.clear();
+    this->m_uf.make_sets(this->m_size);
+    this->m_uf.commit(this->m_uf.mark());
+
+    this->traverse(1, 0, q, queries);
+    this->m_tree.clear();
+  }
+
+  template <class _vertex>
+  std::size_t t_dynamic_connectivity<_vertex>::answer(std::size_t i)const
+  {
+    assert(i < this->m_answers.size());
+    return this->m_answers[i];
+  }
+
+}//end namespace utils
+
+#endif
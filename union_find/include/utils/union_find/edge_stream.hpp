@@ -0,0 +1,436 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_EDGE_STREAM_HPP_
+#define _UTILS_UNION_FIND_EDGE_STREAM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <utils/union_find/parallel.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils{
+  /*
+    Streaming of an edge file into a Union-Find structure (POSIX
+    only). The file is mapped in memory and cut into chunks, which are
+    parsed in parallel by nb_threads - 1 threads while the calling
+    thread unions the edges of the parsed chunks. At most max_chunks
+    parsed chunks wait for the unions, bounding the memory whatever
+    the size of the file. The vertices that do not exist yet in the
+    structure are created with make_sets. A vertex that does not fit
+    in 64 bits, or in the vertex index of the structure, is a parse
+    error.
+
+    The formats of the files are :
+    - TEXT : one edge "u v" per line, separated by spaces or tabs, the
+      next columns being ignored, and the lines starting with '#' or
+      '%' being comments,
+    - BINARY_32 / BINARY_64 : pairs of unsigned integers of 32 / 64
+      bits in the native byte order, a file ending with a partial pair
+      being a parse error.
+
+    The numbers of the text files are parsed 8 digits at a time with
+    SWAR (SIMD within a register) arithmetic on 64 bits words.
+  */
+
+  class t_edge_stream{
+
+    //Types
+
+  public:
+
+    typedef std::uint64_t                 vertex_t;
+    typedef std::pair<vertex_t, vertex_t> edge_t;
+
+    enum format_t{
+      TEXT,
+      BINARY_32,
+      BINARY_64
+    };
+
+    //Attributes
+
+  private:
+
+    format_t    m_format;
+    unsigned    m_nb_threads;
+    std::size_t m_chunk_bytes;
+    std::size_t m_max_chunks;
+    std::size_t m_nb_edges;//number of edges of the last file
+    std::size_t m_nb_bytes;//number of bytes of the last file
+
+    //Constructors
+
+  public:
+
+    //nb_threads is the number of threads (0 for all the cores),
+    //chunk_bytes is rounded up to a multiple of 64 so that the chunks
+    //of the binary files hold whole pairs, max_chunks the number of
+    //parsed chunks waiting for the unions (0 for 2 per thread)
+    t_edge_stream(format_t format = TEXT, unsigned nb_threads = 0, std::size_t chunk_bytes = std::size_t(1) << 22, std::size_t max_chunks = 0);
+
+    //Parsing
+
+  public:
+
+    //returns true iff the 8 bytes of word are decimal digits
+    static bool eight_digits(std::uint64_t word);
+
+    //returns the value of the 8 decimal digits of word, the first
+    //digit being the lowest byte
+    static std::uint64_t parse_eight_digits(std::uint64_t word);
+
+    //parses an unsigned integer at first, returns the end of the
+    //number, or nullptr if it does not fit in vertex_t
+    static const char* parse_number(const char* first, const char* last, vertex_t& value);
+
+    //appends the edges of the text lines in [first, last) to edges,
+    //returns false if a number does not fit in vertex_t
+    static bool parse_text(const char* first, const char* last, std::vector<edge_t>& edges);
+
+    //appends the edges of the binary pairs in [first, last) to edges,
+    //returns false if the range ends with a partial pair
+    template <class _integer>
+    static bool parse_binary(const char* first, const char* last, std::vector<edge_t>& edges);
+
+    //Streaming
+
+  private:
+
+    //returns bytes rounded up to a multiple of 64, at least 64
+    static std::size_t round_chunk_bytes(std::size_t bytes);
+
+    //returns the range of the chunk i in a file of size bytes, a text
+    //line belonging to the chunk of its first byte
+    std::pair<std::size_t, std::size_t> chunk(const char* data, std::size_t size, std::size_t i)const;
+
+    //parses the chunk [first, last), returns false on a parse error
+    bool parse(const char* first, const char* last, std::vector<edge_t>& edges)const;
+
+    //unions the edges, creating the missing vertices, returns false
+    //without any union if a vertex exceeds the vertex index of uf
+    template <class _union_find>
+    static bool union_edges(const std::vector<edge_t>& edges, _union_find& uf);
+
+  public:
+
+    //unions the edges of the file in uf, returns false if the file
+    //cannot be read or on a parse error, uf then holding the unions of
+    //the chunks unioned before the error (O(m / #threads) for parsing,
+    //O(m) for unions)
+    template <class _union_find>
+    bool union_file(const char* path, _union_find& uf);
+
+    //returns the number of edges of the last file (O(1))
+    std::size_t number_of_edges(void)const;
+
+    //returns the number of bytes of the last file (O(1))
+    std::size_t number_of_bytes(void)const;
+
+  };//end class t_edge_stream
+
+  //Implementation
+
+  inline t_edge_stream::t_edge_stream(format_t format, unsigned nb_threads, std::size_t chunk_bytes, std::size_t max_chunks)
+    : m_format(format),
+      m_nb_threads(number_of_threads(nb_threads)),
+      m_chunk_bytes(round_chunk_bytes(chunk_bytes)),
+      m_max_chunks(max_chunks == 0 ? 2 * number_of_threads(nb_threads) : max_chunks),
+      m_nb_edges(0),
+      m_nb_bytes(0)
+  {
+  }
+
+  inline bool t_edge_stream::eight_digits(std::uint64_t word)
+  {
+    //each byte is in [0x30, 0x39] iff its high nibble is 3 before and
+    //after adding 6
+    return (word & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL
+      && ((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL;
+  }
+
+  inline std::uint64_t t_edge_stream::parse_eight_digits(std::uint64_t word)
+  {
+    //pairs of digits, then quadruples, then the 8 digits
+    word -= 0x3030303030303030ULL;
+    word = (word * 10) + (word >> 8);
+    word = (((word & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+	    + (((word >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return word;
+  }
+
+  inline const char* t_edge_stream::parse_number(const char* first, const char* last, vertex_t& value)
+  {
+    static const std::uint16_t probe = 1;
+    static const bool little_endian = *reinterpret_cast<const unsigned char*>(&probe) == 1;
+
+    const vertex_t max = std::numeric_limits<vertex_t>::max();
+    value = 0;
+    if(little_endian)
+      while(last - first >= 8)
+	{
+	  std::uint64_t word;
+	  std::memcpy(&word, first, 8);
+	  if(!eight_digits(word))
+	    break;
+	  std::uint64_t digits = parse_eight_digits(word);
+	  if(value > (max - digits) / 100000000ULL)
+	    return nullptr;
+	  value = value * 100000000ULL + digits;
+	  first += 8;
+	}
+    while(first != last && *first >= '0' && *first <= '9')
+      {
+	vertex_t digit = vertex_t(*first++ - '0');
+	if(value > (max - digit) / 10)
+	  return nullptr;
+	value = value * 10 + digit;
+      }
+    return first;
+  }
+
+  inline bool t_edge_stream::parse_text(const char* first, const char* last, std::vector<edge_t>& edges)
+  {
+    while(first != last)
+      {
+	while(first != last && (*first == ' ' || *first == '\t'))
+	  ++first;
+	const char* eol = static_cast<const char*>(std::memchr(first, '\n', last - first));
+	if(eol == nullptr)
+	  eol = last;
+
+	if(first != eol && *first >= '0' && *first <= '9')
+	  {
+	    edge_t e;
+	    const char* p = parse_number(first, eol, e.first);
+	    if(p == nullptr)
+	      return false;
+	    while(p != eol && (*p == ' ' || *p == '\t' || *p == ','))
+	      ++p;
+	    if(p != eol && *p >= '0' && *p <= '9')
+	      {
+		if(parse_number(p, eol, e.second) == nullptr)
+		  return false;
+		edges.push_back(e);
+	      }
+	  }
+
+	first = eol == last ? last : eol + 1;
+      }
+    return true;
+  }
+
+  template <class _integer>
+  bool t_edge_stream::parse_binary(const char* first, const char* last, std::vector<edge_t>& edges)
+  {
+    _integer pair[2];
+    for(; last - first >= std::ptrdiff_t(sizeof(pair)); first += sizeof(pair))
+      {
+	std::memcpy(pair, first, sizeof(pair));
+	edges.push_back(edge_t(pair[0], pair[1]));
+      }
+    return first == last;
+  }
+
+  inline std::size_t t_edge_stream::round_chunk_bytes(std::size_t bytes)
+  {
+    //the largest sizes are rounded down instead of wrapping
+    std::size_t rounded = std::max<std::size_t>(bytes, 64) / 64 * 64;
+    return rounded < bytes && rounded <= std::numeric_limits<std::size_t>::max() - 64 ? rounded + 64 : rounded;
+  }
+
+  inline std::pair<std::size_t, std::size_t> t_edge_stream::chunk(const char* data, std::size_t size, std::size_t i)const
+  {
+    std::size_t begin = std::min(size, i * this->m_chunk_bytes);
+    std::size_t end = std::min(size, begin + this->m_chunk_bytes);
+    if(this->m_format != TEXT)
+      return std::make_pair(begin, end);
+
+    //move both bounds after the end of their line
+    if(begin > 0 && data[begin - 1] != '\n')
+      {
+	const char* eol = static_cast<const char*>(std::memchr(data + begin, '\n', size - begin));
+	begin = eol == nullptr ? size : std::size_t(eol - data) + 1;
+      }
+    if(end > 0 && data[end - 1] != '\n')
+      {
+	const char* eol = static_cast<const char*>(std::memchr(data + end, '\n', size - end));
+	end = eol == nullptr ? size : std::size_t(eol - data) + 1;
+      }
+    return std::make_pair(begin, std::max(begin, end));
+  }
+
+  inline bool t_edge_stream::parse(const char* first, const char* last, std::vector<edge_t>& edges)const
+  {
+    switch(this->m_format)
+      {
+      case TEXT      : return parse_text(first, last, edges);
+      case BINARY_32 : return parse_binary<std::uint32_t>(first, last, edges);
+      case BINARY_64 : return parse_binary<std::uint64_t>(first, last, edges);
+      }
+    return false;
+  }
+
+  template <class _union_find>
+  bool t_edge_stream::union_edges(const std::vector<edge_t>& edges, _union_find& uf)
+  {
+    typedef typename _union_find::vertex_t uf_vertex_t;
+
+    //a vertex u needs u + 1 <= max_size() vertices, which also keeps
+    //u + 1 from wrapping
+    vertex_t n = 0;
+    for(const edge_t& e : edges)
+      {
+	vertex_t u = std::max(e.first, e.second);
+	if(u >= vertex_t(uf.max_size()))
+	  return false;
+	n = std::max(n, u + 1);
+      }
+    if(n > uf.size())
+      uf.make_sets(std::size_t(n - uf.size()));
+    for(const edge_t& e : edges)
+      uf.union_sets(uf_vertex_t(e.first), uf_vertex_t(e.second));
+    return true;
+  }
+
+  template <class _union_find>
+  bool t_edge_stream::union_file(const char* path, _union_find& uf)
+  {
+    this->m_nb_edges = 0;
+    this->m_nb_bytes = 0;
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+      return false;
+    struct stat status;
+    if(::fstat(fd, &status) != 0)
+      {
+	::close(fd);
+	return false;
+      }
+    std::size_t size = std::size_t(status.st_size);
+    if(size == 0)
+      {
+	::close(fd);
+	return true;
+      }
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(address == MAP_FAILED)
+      return false;
+    ::madvise(address, size, MADV_SEQUENTIAL);
+
+    const char* data = static_cast<const char*>(address);
+    std::size_t nb_chunks = (size + this->m_chunk_bytes - 1) / this->m_chunk_bytes;
+    bool ok = true;
+
+    if(this->m_nb_threads == 1)
+      {
+	//parse and union each chunk in turn
+	std::vector<edge_t> edges;
+	for(std::size_t i = 0; ok && i < nb_chunks; i++)
+	  {
+	    std::pair<std::size_t, std::size_t> range = this->chunk(data, size, i);
+	    edges.clear();
+	    ok = this->parse(data + range.first, data + range.second, edges) && union_edges(edges, uf);
+	    if(ok)
+	      this->m_nb_edges += edges.size();
+	  }
+      }
+    else
+      {
+	//the parsers push the parsed chunks in a bounded queue, that
+	//is emptied by the calling thread; after a parse error, the
+	//parsers stop and the queue is only drained
+	std::atomic<std::size_t>        next_chunk(0);
+	std::atomic<bool>               failed(false);
+	std::mutex                      mutex;
+	std::condition_variable         not_full;
+	std::condition_variable         not_empty;
+	std::deque<std::vector<edge_t> > queue;
+	std::size_t                     max_chunks = this->m_max_chunks;
+
+	std::vector<std::thread> parsers;
+	for(unsigned t = 1; t < this->m_nb_threads; t++)
+	  parsers.push_back(std::thread([this, data, size, nb_chunks, max_chunks, &next_chunk, &failed, &mutex, &not_full, &not_empty, &queue](){
+		for(std::size_t i = next_chunk++; i < nb_chunks; i = next_chunk++)
+		  {
+		    std::pair<std::size_t, std::size_t> range = this->chunk(data, size, i);
+		    std::vector<edge_t> edges;
+		    if(failed.load(std::memory_order_relaxed) || !this->parse(data + range.first, data + range.second, edges))
+		      {
+			failed.store(true, std::memory_order_relaxed);
+			edges.clear();
+		      }
+
+		    std::unique_lock<std::mutex> lock(mutex);
+		    not_full.wait(lock, [&queue, max_chunks](){return queue.size() < max_chunks;});
+		    queue.push_back(std::vector<edge_t>());
+		    queue.back().swap(edges);
+		    not_empty.notify_one();
+		  }
+	      }));
+
+	for(std::size_t consumed = 0; consumed < nb_chunks; consumed++)
+	  {
+	    std::vector<edge_t> edges;
+	    {
+	      std::unique_lock<std::mutex> lock(mutex);
+	      not_empty.wait(lock, [&queue](){return !queue.empty();});
+	      edges.swap(queue.front());
+	      queue.pop_front();
+	      not_full.notify_one();
+	    }
+	    if(!failed.load(std::memory_order_relaxed) && union_edges(edges, uf))
+	      this->m_nb_edges += edges.size();
+	    else
+	      failed.store(true, std::memory_order_relaxed);
+	  }
+	ok = !failed.load();
+
+	for(std::thread& parser : parsers)
+	  parser.join();
+      }
+
+    ::munmap(address, size);
+    this->m_nb_bytes = size;
+    return ok;
+  }
+
+  inline std::size_t t_edge_stream::number_of_edges(void)const
+  {
+    return this->m_nb_edges;
+  }
+
+  inline std::size_t t_edge_stream::number_of_bytes(void)const
+  {
+    return this->m_nb_bytes;
+  }
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,305 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_FROZEN_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_FROZEN_UNION_FIND_HPP_
+
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <utils/union_find/parallel.hpp>
+
+namespace utils{
+  /*
+    An immutable snapshot of the independent sets of a Union-Find
+    structure, obtained with t_union_find::freeze(). The independent
+    sets are labeled from 0 to k-1 in the order of their leaders, and
+    the members of each set are stored contiguously in increasing
+    order (compressed sparse row layout) :
+
+    - label(u) is the label of the set containing u,
+    - members[offsets[l]], ..., members[offsets[l+1]-1] are the
+      vertices of the set labeled l.
+
+    The vertices that are not in any set (e.g. removed with
+    t_free_list) have the label ABSENT and are in no set.
+
+    All the queries are const, O(1) and safe to call from any number
+    of threads.
+  */
+
+  template <class _vertex = std::size_t>
+  class t_frozen_union_find{
+
+    //Types
+
+  public:
+
+    typedef _vertex vertex_t;
+    typedef _vertex label_t;
+
+    //label of the vertices in no set
+    static const label_t ABSENT;
+
+    //Attributes
+
+  private:
+
+    std::vector<label_t>     m_labels;//label of each vertex
+    std::vector<std::size_t> m_offsets;//start of each set in m_members, and the number of vertices
+    std::vector<vertex_t>    m_members;//vertices sorted by label then by index
+
+    //Constructors
+
+  public:
+
+    t_frozen_union_find(void);
+
+    //builds the snapshot of n vertices from the leader of each vertex,
+    //or ABSENT for a vertex in no set, leader(u) being called
+    //concurrently (O(n / #threads + k) time, O(k * #threads) extra
+    //space for k sets)
+    template <class _leader>
+    t_frozen_union_find(std::size_t n, _leader leader, unsigned nb_threads = 0);
+
+    //Queries
+
+  public:
+
+    //returns true iff there is no vertex (O(1))
+    bool empty(void)const;
+
+    //returns the number of vertices (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of independent sets (O(1))
+    std::size_t number_of_independent_sets(void)const;
+
+    //returns the label of the set containing u, ABSENT if u is in no
+    //set (O(1))
+    label_t label(vertex_t u)const;
+
+    //returns true iff u and v are in the same set, false if one of
+    //them is in no set (O(1))
+    bool same_set(vertex_t u, vertex_t v)const;
+
+    //returns the number of vertices in the set labeled l (O(1))
+    std::size_t label_size(label_t l)const;
+
+    //returns the number of vertices in the set containing u, 0 if u is
+    //in no set (O(1))
+    std::size_t set_size(vertex_t u)const;
+
+    //returns the range of the vertices in the set labeled l (O(1))
+    const vertex_t* members_begin(label_t l)const;
+    const vertex_t* members_end(label_t l)const;
+
+    //fills the input container with all the vertices in the set
+    //containing u (O(|set|))
+    template<class _output_iterator>
+    _output_iterator independent_set(vertex_t u, _output_iterator out)const;
+
+    //fills the input container with the smallest vertex of each set,
+    //by increasing label (O(k))
+    template<class _output_iterator>
+    _output_iterator leaders(_output_iterator out)const;
+
+  };//end class t_frozen_union_find
+
+  //Implementation
+
+  template <class _vertex>
+  const typename t_frozen_union_find<_vertex>::label_t t_frozen_union_find<_vertex>::ABSENT = std::numeric_limits<label_t>::max();
+
+  template <class _vertex>
+  t_frozen_union_find<_vertex>::t_frozen_union_find(void)
+    : m_labels(),
+      m_offsets(1, 0),
+      m_members()
+  {
+  }
+
+  template <class _vertex>
+  template <class _leader>
+  t_frozen_union_find<_vertex>::t_frozen_union_find(std::size_t n, _leader leader, unsigned nb_threads)
+    : m_labels(n),
+      m_offsets(),
+      m_members(n)
+  {
+    nb_threads = number_of_threads(nb_threads);
+    std::vector<label_t>& labels = this->m_labels;
+
+    //the leader of each vertex, temporarily stored in the labels
+    parallel_for(n, nb_threads, [&labels, &leader](std::size_t u){
+	labels[u] = label_t(leader(vertex_t(u)));
+      });
+
+    //the leaders of the vertices in a set, a leader being possibly
+    //in no set itself (e.g. a removed vertex still in its tree)
+    std::unique_ptr<std::atomic<unsigned char>[]> is_leader(new std::atomic<unsigned char>[n]);
+    parallel_for(n, nb_threads, [&is_leader](std::size_t u){
+	is_leader[u].store(0, std::memory_order_relaxed);
+      });
+    parallel_for(n, nb_threads, [&labels, &is_leader](std::size_t u){
+	if(labels[u] != ABSENT)
+	  is_leader[labels[u]].store(1, std::memory_order_relaxed);
+      });
+
+    //the leaders are labeled in increasing order : each block counts
+    //its leaders, then labels them from the prefix sum of the counts
+    std::vector<label_t> leader_labels(n);
+    std::vector<std::size_t> block_counts(nb_threads + 1, 0);
+    parallel_blocks(n, nb_threads, [&is_leader, &block_counts](std::size_t begin, std::size_t end, unsigned t){
+	for(std::size_t u = begin; u < end; u++)
+	  if(is_leader[u].load(std::memory_order_relaxed))
+	    block_counts[t + 1]++;
+      });
+    for(unsigned t = 0; t < nb_threads; t++)
+      block_counts[t + 1] += block_counts[t];
+    parallel_blocks(n, nb_threads, [&is_leader, &leader_labels, &block_counts](std::size_t begin, std::size_t end, unsigned t){
+	std::size_t l = block_counts[t];
+	for(std::size_t u = begin; u < end; u++)
+	  if(is_leader[u].load(std::memory_order_relaxed))
+	    leader_labels[u] = label_t(l++);
+      });
+    std::size_t k = block_counts[nb_threads];
+
+    //the members are placed by a stable counting pass : the vertices
+    //are split in one block of n / #threads vertices per thread, each
+    //block counting its vertices of each set, so that the vertices of
+    //a block are placed after the ones of the previous blocks. The
+    //counts take k words per block, whatever the number of sets : up
+    //to n words per thread when most vertices are alone in their set.
+    unsigned nb_blocks = unsigned(std::min<std::size_t>(nb_threads, std::max<std::size_t>(n, 1)));
+    std::vector<std::size_t> cursors(std::size_t(nb_blocks) * k, 0);
+    parallel_blocks(n, nb_blocks, [&labels, &leader_labels, &cursors, k](std::size_t begin, std::size_t end, unsigned t){
+	std::size_t* counts = cursors.data() + std::size_t(t) * k;
+	for(std::size_t u = begin; u < end; u++)
+	  if(labels[u] != ABSENT)
+	    counts[labels[u] = leader_labels[labels[u]]]++;
+      });
+
+    //compressed sparse row layout of the members, the counts of each
+    //block becoming the position of its first vertex in each set
+    this->m_offsets.assign(k + 1, 0);
+    std::vector<std::size_t>& offsets = this->m_offsets;
+    parallel_for(k, nb_threads, [&offsets, &cursors, k, nb_blocks](std::size_t l){
+	for(unsigned t = 0; t < nb_blocks; t++)
+	  offsets[l + 1] += cursors[std::size_t(t) * k + l];
+      });
+    for(std::size_t l = 0; l < k; l++)
+      offsets[l + 1] += offsets[l];
+    parallel_for(k, nb_threads, [&offsets, &cursors, k, nb_blocks](std::size_t l){
+	std::size_t position = offsets[l];
+	for(unsigned t = 0; t < nb_blocks; t++)
+	  {
+	    std::size_t count = cursors[std::size_t(t) * k + l];
+	    cursors[std::size_t(t) * k + l] = position;
+	    position += count;
+	  }
+      });
+    std::vector<vertex_t>& members = this->m_members;
+    parallel_blocks(n, nb_blocks, [&labels, &members, &cursors, k](std::size_t begin, std::size_t end, unsigned t){
+	std::size_t* positions = cursors.data() + std::size_t(t) * k;
+	for(std::size_t u = begin; u < end; u++)
+	  if(labels[u] != ABSENT)
+	    members[positions[labels[u]]++] = vertex_t(u);
+      });
+    members.resize(offsets[k]);
+  }
+
+  template <class _vertex>
+  bool t_frozen_union_find<_vertex>::empty(void)const
+  {
+    return this->m_labels.empty();
+  }
+
+  template <class _vertex>
+  std::size_t t_frozen_union_find<_vertex>::size(void)const
+  {
+    return this->m_labels.size();
+  }
+
+  template <class _vertex>
+  std::size_t t_frozen_union_find<_vertex>::number_of_independent_sets(void)const
+  {
+    return this->m_offsets.size() - 1;
+  }
+
+  template <class _vertex>
+  typename t_frozen_union_find<_vertex>::label_t t_frozen_union_find<_vertex>::label(vertex_t u)const
+  {
+    assert(u < this->size());
+    return this->m_labels[u];
+  }
+
+  template <class _vertex>
+  bool t_frozen_union_find<_vertex>::same_set(vertex_t u, vertex_t v)const
+  {
+    return this->label(u) != ABSENT && this->label(u) == this->label(v);
+  }
+
+  template <class _vertex>
+  std::size_t t_frozen_union_find<_vertex>::label_size(label_t l)const
+  {
+    assert(l < this->number_of_independent_sets());
+    return this->m_offsets[l + 1] - this->m_offsets[l];
+  }
+
+  template <class _vertex>
+  std::size_t t_frozen_union_find<_vertex>::set_size(vertex_t u)const
+  {
+    return this->label(u) == ABSENT ? 0 : this->label_size(this->label(u));
+  }
+
+  template <class _vertex>
+  const typename t_frozen_union_find<_vertex>::vertex_t* t_frozen_union_find<_vertex>::members_begin(label_t l)const
+  {
+    assert(l < this->number_of_independent_sets());
+    return this->m_members.data() + this->m_offsets[l];
+  }
+
+  template <class _vertex>
+  const typename t_frozen_union_find<_vertex>::vertex_t* t_frozen_union_find<_vertex>::members_end(label_t l)const
+  {
+    assert(l < this->number_of_independent_sets());
+    return this->m_members.data() + this->m_offsets[l + 1];
+  }
+
+  template <class _vertex>
+  template<class _output_iterator>
+  _output_iterator t_frozen_union_find<_vertex>::independent_set(vertex_t u, _output_iterator out)const
+  {
+    label_t l = this->label(u);
+    if(l == ABSENT)
+      return out;
+    return std::copy(this->members_begin(l), this->members_end(l), out);
+  }
+
+  template <class _vertex>
+  template<class _output_iterator>
+  _output_iterator t_frozen_union_find<_vertex>::leaders(_output_iterator out)const
+  {
+    for(std::size_t l = 0; l < this->number_of_independent_sets(); l++)
+      *out++ = this->m_members[this->m_offsets[l]];
+    return out;
+  }
+
+}//end namespace utils
+
+#endif
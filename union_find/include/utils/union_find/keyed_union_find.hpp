@@ -0,0 +1,477 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_KEYED_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_KEYED_UNION_FIND_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <utils/union_find.hpp>
+#include <utils/union_find/prefetch.hpp>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace utils{
+  /*
+    A Union-Find structure on arbitrary keys (integers, strings...),
+    each key getting a vertex of the underlying Union-Find structure
+    the first time it is seen.
+
+    The keys are mapped to their vertex by an open-addressing flat
+    hash table : one control byte per slot holds 7 bits of the hash of
+    its key, or EMPTY, and the slots are probed by groups of 16 whose
+    control bytes are compared at once (SSE2 if available, a loop
+    otherwise). The slots only store the vertices, the keys being
+    stored once by vertex, so that the table costs one byte plus one
+    vertex index per slot, with a load factor of at most 7/8 and no
+    allocation per key.
+
+    The batched union_keys hashes a block of pairs of keys and
+    prefetches their groups before resolving them, hiding the latency
+    of the probes on large tables.
+
+    The key of a vertex is stored at its index, so that the underlying
+    structure cannot recycle the indices of removed vertices
+    (t_free_list).
+  */
+
+  template <class _key, class _hash = std::hash<_key>, class _union_find = t_union_find<> >
+  class t_keyed_union_find{
+
+    //Types
+
+  public:
+
+    typedef _key                             key_t;
+    typedef _union_find                      union_find_t;
+    typedef typename union_find_t::vertex_t  vertex_t;
+
+    static const std::size_t GROUP = 16;//number of slots probed at once
+    static const std::size_t BATCH = 16;//number of pairs hashed and prefetched at once
+
+  private:
+
+    static const std::uint8_t EMPTY = 0x80;
+
+    static_assert(!std::is_same<typename union_find_t::removal_policy_t, t_free_list>::value, "the keys are stored by vertex, which t_free_list would recycle");
+
+    //Attributes
+
+  private:
+
+    union_find_t              m_uf;
+    std::vector<key_t>        m_keys;//key of each vertex
+    std::vector<std::uint8_t> m_control;//EMPTY or 7 bits of the hash of each slot
+    std::vector<vertex_t>     m_slots;//vertex of each slot
+    std::size_t               m_group_mask;//number of groups - 1
+    _hash                     m_hash;
+
+    //Constructors
+
+  public:
+
+    t_keyed_union_find(const _hash& hash = _hash());
+
+    //Internal
+
+  private:
+
+    //hash of the key, mixed so that all its bits are usable
+    std::size_t hash(const key_t& key)const;
+
+    //bit i is set iff the control byte i of the group equals tag
+    static unsigned match(const std::uint8_t* group, std::uint8_t tag);
+
+    //bit i is set iff the slot i of the group is empty
+    static unsigned match_empty(const std::uint8_t* group);
+
+    static unsigned first_bit(unsigned mask);
+
+    //returns the number of slots
+    std::size_t capacity(void)const;
+
+    //prefetches the first group probed for the hash h
+    void prefetch_group(std::size_t h)const;
+
+    //returns the slot of the key, or the empty slot ending its probe
+    //sequence
+    std::size_t probe(const key_t& key, std::size_t h, bool& found)const;
+
+    //rebuilds the table with the given number of groups
+    void rehash(std::size_t nb_groups);
+
+    //returns the vertex of the key of hash h, created if needed
+    vertex_t insert(const key_t& key, std::size_t h);
+
+    //Keys
+
+  public:
+
+    //removes all the keys (O(1))
+    void clear(void);
+
+    //allocates the memory for n keys (O(n))
+    void reserve(std::size_t n);
+
+    //returns true iff the key has a vertex (~O(1))
+    bool contains(const key_t& key)const;
+
+    //returns the vertex of the key, making a new set for an unseen key
+    //(~O(1))
+    vertex_t vertex(const key_t& key);
+
+    //returns the key of the vertex u (O(1))
+    const key_t& key(vertex_t u)const;
+
+    //returns the underlying Union-Find structure
+    const union_find_t& union_find(void)const;
+
+    //Base operations
+
+  public:
+
+    //finds the leader of the set containing the key (~O(1))
+    vertex_t find_set(const key_t& key);
+
+    //unions the sets of the two keys, returns the leader (~O(1))
+    vertex_t union_keys(const key_t& a, const key_t& b);
+
+    //unions the sets of each pair of keys in [first, last) (~O(m))
+    template <class _forward_iterator>
+    void union_keys(_forward_iterator first, _forward_iterator last);
+
+    //returns true iff the two keys are in the same set, an unseen key
+    //being only in the set of itself (~O(1))
+    bool same_set(const key_t& a, const key_t& b);
+
+    //Independent sets
+
+  public:
+
+    //returns true iff there is no key (O(1))
+    bool empty(void)const;
+
+    //returns the number of keys (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of independent sets (O(1))
+    std::size_t number_of_independent_sets(void)const;
+
+    //fills the input container with all the keys in the set
+    //containing the key (O(n))
+    template<class _output_iterator>
+    _output_iterator independent_set(const key_t& key, _output_iterator out);
+
+  };//end class t_keyed_union_find
+
+  //Implementation
+
+  template <class _key, class _hash, class _union_find>
+  const std::size_t t_keyed_union_find<_key, _hash, _union_find>::GROUP;
+
+  template <class _key, class _hash, class _union_find>
+  const std::size_t t_keyed_union_find<_key, _hash, _union_find>::BATCH;
+
+  template <class _key, class _hash, class _union_find>
+  const std::uint8_t t_keyed_union_find<_key, _hash, _union_find>::EMPTY;
+
+  template <class _key, class _hash, class _union_find>
+  t_keyed_union_find<_key, _hash, _union_find>::t_keyed_union_find(const _hash& hash)
+    : m_uf(),
+      m_keys(),
+      m_control(),
+      m_slots(),
+      m_group_mask(0),
+      m_hash(hash)
+  {
+  }
+
+  template <class _key, class _hash, class _union_find>
+  std::size_t t_keyed_union_find<_key, _hash, _union_find>::hash(const key_t& key)const
+  {
+    //std::hash is the identity on the integers of most libraries
+    std::uint64_t h = std::uint64_t(this->m_hash(key));
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return std::size_t(h ^ (h >> 31));
+  }
+
+  template <class _key, class _hash, class _union_find>
+  unsigned t_keyed_union_find<_key, _hash, _union_find>::match(const std::uint8_t* group, std::uint8_t tag)
+  {
+#if defined(__SSE2__)
+    __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(char(tag)))));
+#else
+    unsigned mask = 0;
+    for(std::size_t i = 0; i < GROUP; i++)
+      mask |= unsigned(group[i] == tag) << i;
+    return mask;
+#endif
+  }
+
+  template <class _key, class _hash, class _union_find>
+  unsigned t_keyed_union_find<_key, _hash, _union_find>::match_empty(const std::uint8_t* group)
+  {
+#if defined(__SSE2__)
+    //EMPTY is the only control byte with its highest bit set
+    return unsigned(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+    return match(group, EMPTY);
+#endif
+  }
+
+  template <class _key, class _hash, class _union_find>
+  unsigned t_keyed_union_find<_key, _hash, _union_find>::first_bit(unsigned mask)
+  {
+    assert(mask != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return unsigned(__builtin_ctz(mask));
+#else
+    unsigned i = 0;
+    while(((mask >> i) & 1) == 0)
+      i++;
+    return i;
+#endif
+  }
+
+  template <class _key, class _hash, class _union_find>
+  std::size_t t_keyed_union_find<_key, _hash, _union_find>::capacity(void)const
+  {
+    return this->m_control.size();
+  }
+
+  template <class _key, class _hash, class _union_find>
+  void t_keyed_union_find<_key, _hash, _union_find>::prefetch_group(std::size_t h)const
+  {
+    if(this->capacity() == 0)
+      return;
+    std::size_t g = (h >> 7) & this->m_group_mask;
+    prefetch(this->m_control.data() + g * GROUP);
+    prefetch(this->m_slots.data() + g * GROUP);
+  }
+
+  template <class _key, class _hash, class _union_find>
+  std::size_t t_keyed_union_find<_key, _hash, _union_find>::probe(const key_t& key, std::size_t h, bool& found)const
+  {
+    assert(this->capacity() > 0);
+
+    //triangular probing of the groups, that visits all of them since
+    //their number is a power of 2
+    std::uint8_t tag = std::uint8_t(h & 0x7F);
+    std::size_t g = (h >> 7) & this->m_group_mask;
+    for(std::size_t step = 1; ; step++)
+      {
+	const std::uint8_t* group = this->m_control.data() + g * GROUP;
+	for(unsigned mask = match(group, tag); mask != 0; mask &= mask - 1)
+	  {
+	    std::size_t slot = g * GROUP + first_bit(mask);
+	    if(this->m_keys[this->m_slots[slot]] == key)
+	      {
+		found = true;
+		return slot;
+	      }
+	  }
+	unsigned empty = match_empty(group);
+	if(empty != 0)
+	  {
+	    found = false;
+	    return g * GROUP + first_bit(empty);
+	  }
+	g = (g + step) & this->m_group_mask;
+      }
+  }
+
+  template <class _key, class _hash, class _union_find>
+  void t_keyed_union_find<_key, _hash, _union_find>::rehash(std::size_t nb_groups)
+  {
+    assert(nb_groups > 0 && (nb_groups & (nb_groups - 1)) == 0);
+
+    this->m_control.assign(nb_groups * GROUP, EMPTY);
+    this->m_slots.assign(nb_groups * GROUP, vertex_t(0));
+    this->m_group_mask = nb_groups - 1;
+    for(std::size_t u = 0; u < this->m_keys.size(); u++)
+      {
+	std::size_t h = this->hash(this->m_keys[u]);
+	bool found;
+	std::size_t slot = this->probe(this->m_keys[u], h, found);
+	this->m_control[slot] = std::uint8_t(h & 0x7F);
+	this->m_slots[slot] = vertex_t(u);
+      }
+  }
+
+  template <class _key, class _hash, class _union_find>
+  typename t_keyed_union_find<_key, _hash, _union_find>::vertex_t t_keyed_union_find<_key, _hash, _union_find>::insert(const key_t& key, std::size_t h)
+  {
+    bool found = false;
+    std::size_t slot = 0;
+    if(this->capacity() > 0)
+      {
+	slot = this->probe(key, h, found);
+	if(found)
+	  return this->m_slots[slot];
+      }
+
+    //grows the table beyond a load factor of 7/8
+    if(8 * (this->size() + 1) > 7 * this->capacity())
+      {
+	this->rehash(this->capacity() == 0 ? 1 : 2 * (this->m_group_mask + 1));
+	slot = this->probe(key, h, found);
+      }
+
+    vertex_t u = this->m_uf.make_set();
+    this->m_keys.push_back(key);
+    this->m_control[slot] = std::uint8_t(h & 0x7F);
+    this->m_slots[slot] = u;
+    return u;
+  }
+
+  template <class _key, class _hash, class _union_find>
+  void t_keyed_union_find<_key, _hash, _union_find>::clear(void)
+  {
+    this->m_uf.clear();
+    this->m_keys.clear();
+    this->m_control.clear();
+    this->m_slots.clear();
+    this->m_group_mask = 0;
+  }
+
+  template <class _key, class _hash, class _union_find>
+  void t_keyed_union_find<_key, _hash, _union_find>::reserve(std::size_t n)
+  {
+    this->m_keys.reserve(n);
+    std::size_t nb_groups = 1;
+    while(7 * nb_groups * GROUP < 8 * n)
+      nb_groups *= 2;
+    if(nb_groups * GROUP > this->capacity())
+      this->rehash(nb_groups);
+  }
+
+  template <class _key, class _hash, class _union_find>
+  bool t_keyed_union_find<_key, _hash, _union_find>::contains(const key_t& key)const
+  {
+    bool found = false;
+    if(this->capacity() > 0)
+      this->probe(key, this->hash(key), found);
+    return found;
+  }
+
+  template <class _key, class _hash, class _union_find>
+  typename t_keyed_union_find<_key, _hash, _union_find>::vertex_t t_keyed_union_find<_key, _hash, _union_find>::vertex(const key_t& key)
+  {
+    return this->insert(key, this->hash(key));
+  }
+
+  template <class _key, class _hash, class _union_find>
+  const typename t_keyed_union_find<_key, _hash, _union_find>::key_t& t_keyed_union_find<_key, _hash, _union_find>::key(vertex_t u)const
+  {
+    assert(u < this->size());
+    return this->m_keys[u];
+  }
+
+  template <class _key, class _hash, class _union_find>
+  const typename t_keyed_union_find<_key, _hash, _union_find>::union_find_t& t_keyed_union_find<_key, _hash, _union_find>::union_find(void)const
+  {
+    return this->m_uf;
+  }
+
+  template <class _key, class _hash, class _union_find>
+  typename t_keyed_union_find<_key, _hash, _union_find>::vertex_t t_keyed_union_find<_key, _hash, _union_find>::find_set(const key_t& key)
+  {
+    return this->m_uf.find_set(this->vertex(key));
+  }
+
+  template <class _key, class _hash, class _union_find>
+  typename t_keyed_union_find<_key, _hash, _union_find>::vertex_t t_keyed_union_find<_key, _hash, _union_find>::union_keys(const key_t& a, const key_t& b)
+  {
+    vertex_t u = this->vertex(a);
+    vertex_t v = this->vertex(b);
+    return this->m_uf.union_sets(u, v);
+  }
+
+  template <class _key, class _hash, class _union_find>
+  template <class _forward_iterator>
+  void t_keyed_union_find<_key, _hash, _union_find>::union_keys(_forward_iterator first, _forward_iterator last)
+  {
+    //the hashes do not depend on the capacity, so they stay valid if
+    //the table grows within a block
+    std::size_t hashes[2 * BATCH];
+    while(first != last)
+      {
+	_forward_iterator block = first;
+	std::size_t n = 0;
+	for(; n < BATCH && first != last; n++, ++first)
+	  {
+	    hashes[2 * n] = this->hash(first->first);
+	    hashes[2 * n + 1] = this->hash(first->second);
+	    this->prefetch_group(hashes[2 * n]);
+	    this->prefetch_group(hashes[2 * n + 1]);
+	  }
+	for(std::size_t i = 0; i < n; i++, ++block)
+	  {
+	    vertex_t u = this->insert(block->first, hashes[2 * i]);
+	    vertex_t v = this->insert(block->second, hashes[2 * i + 1]);
+	    this->m_uf.union_sets(u, v);
+	  }
+      }
+  }
+
+  template <class _key, class _hash, class _union_find>
+  bool t_keyed_union_find<_key, _hash, _union_find>::same_set(const key_t& a, const key_t& b)
+  {
+    if(a == b)
+      return true;
+    if(!this->contains(a) || !this->contains(b))
+      return false;
+    return this->find_set(a) == this->find_set(b);
+  }
+
+  template <class _key, class _hash, class _union_find>
+  bool t_keyed_union_find<_key, _hash, _union_find>::empty(void)const
+  {
+    return this->size() == 0;
+  }
+
+  template <class _key, class _hash, class _union_find>
+  std::size_t t_keyed_union_find<_key, _hash, _union_find>::size(void)const
+  {
+    return this->m_keys.size();
+  }
+
+  template <class _key, class _hash, class _union_find>
+  std::size_t t_keyed_union_find<_key, _hash, _union_find>::number_of_independent_sets(void)const
+  {
+    return this->m_uf.number_of_independent_sets();
+  }
+
+  template <class _key, class _hash, class _union_find>
+  template<class _output_iterator>
+  _output_iterator t_keyed_union_find<_key, _hash, _union_find>::independent_set(const key_t& key, _output_iterator out)
+  {
+    std::vector<vertex_t> vertices;
+    this->m_uf.independent_set(this->vertex(key), std::back_inserter(vertices));
+    for(vertex_t u : vertices)
+      *out++ = this->m_keys[u];
+    return out;
+  }
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,297 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_KRUSKAL_HPP_
+#define _UTILS_UNION_FIND_KRUSKAL_HPP_
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include <utils/union_find.hpp>
+
+namespace utils{
+  /*
+    Minimum spanning forest and single-linkage clustering of a
+    weighted graph, with the Filter-Kruskal algorithm : the edges are
+    partitioned around a pivot weight, the light half is processed
+    first, then the edges of the heavy half whose vertices are already
+    connected are filtered out before processing it. Only the small
+    ranges are sorted, and on dense graphs most edges are rejected by
+    the filter instead of being sorted. The filter uses
+    t_union_find::same_set_batch, on several threads for the large
+    ranges.
+
+    The result is made of two compact arrays :
+    - the edges of the minimum spanning forest, by increasing weight,
+    - the dendrogram of the single-linkage clustering : the n vertices
+      are the clusters 0 to n-1, and the merge i joins two clusters at
+      its height (the weight of the edge) into the cluster n + i.
+  */
+
+  template <class _weight = double, class _vertex = std::size_t>
+  class t_kruskal{
+
+    //Types
+
+  public:
+
+    typedef _vertex                                 vertex_t;
+    typedef _weight                                 weight_t;
+    typedef std::tuple<vertex_t, vertex_t, weight_t> edge_t;
+
+    //a merge of two clusters of the dendrogram
+    struct merge_t{
+      vertex_t first;//cluster merged
+      vertex_t second;//cluster merged
+      weight_t height;//weight of the edge that merged them
+      vertex_t size;//number of vertices of the new cluster
+    };
+
+    static const std::size_t SORT_THRESHOLD   = 1024;//ranges sorted instead of partitioned
+    static const std::size_t FILTER_SAMPLE    = 64;//edges tested before filtering a range
+    static const std::size_t PARALLEL_FILTER  = std::size_t(1) << 16;//ranges filtered with several threads
+
+  private:
+
+    typedef t_union_find<false, t_vertex_index<vertex_t>, t_link_by_size> union_find_t;
+
+    //a range of edges to process, filtered first if needed
+    struct t_range{
+      std::size_t begin;
+      std::size_t end;
+      bool        filter;
+    };
+
+    //Attributes
+
+  private:
+
+    unsigned              m_nb_threads;
+    union_find_t          m_uf;
+    std::vector<vertex_t> m_clusters;//cluster of each leader
+    std::vector<edge_t>   m_forest;
+    std::vector<merge_t>  m_dendrogram;
+
+    //Constructors
+
+  public:
+
+    //nb_threads is the number of threads of the filter (0 for all the
+    //cores)
+    t_kruskal(unsigned nb_threads = 0);
+
+    //Internal
+
+  private:
+
+    //adds the edges of [first, last) sorted by weight to the forest
+    void kruskal(typename std::vector<edge_t>::iterator first, typename std::vector<edge_t>::iterator last);
+
+    //removes the edges of [first, last) whose vertices are connected,
+    //if enough of them are, returns the new end
+    typename std::vector<edge_t>::iterator filter(typename std::vector<edge_t>::iterator first, typename std::vector<edge_t>::iterator last);
+
+    //returns a pivot weight, the median of a sample of the edges
+    static weight_t pivot(typename std::vector<edge_t>::const_iterator first, typename std::vector<edge_t>::const_iterator last);
+
+    //Computation
+
+  public:
+
+    //computes the minimum spanning forest and the dendrogram of the
+    //graph of n vertices, the edges being reordered (O(m + n log n log
+    //(m / n)) expected)
+    void run(std::size_t n, std::vector<edge_t>& edges);
+
+    //returns the edges of the minimum spanning forest (O(1))
+    const std::vector<edge_t>& forest(void)const;
+
+    //returns the merges of the single-linkage dendrogram (O(1))
+    const std::vector<merge_t>& dendrogram(void)const;
+
+    //returns the total weight of the forest (O(n))
+    weight_t total_weight(void)const;
+
+    //returns the number of connected components of the graph (O(1))
+    std::size_t number_of_components(void)const;
+
+  };//end class t_kruskal
+
+  //Implementation
+
+  template <class _weight, class _vertex>
+  const std::size_t t_kruskal<_weight, _vertex>::SORT_THRESHOLD;
+
+  template <class _weight, class _vertex>
+  const std::size_t t_kruskal<_weight, _vertex>::FILTER_SAMPLE;
+
+  template <class _weight, class _vertex>
+  const std::size_t t_kruskal<_weight, _vertex>::PARALLEL_FILTER;
+
+  template <class _weight, class _vertex>
+  t_kruskal<_weight, _vertex>::t_kruskal(unsigned nb_threads)
+    : m_nb_threads(number_of_threads(nb_threads)),
+      m_uf(),
+      m_clusters(),
+      m_forest(),
+      m_dendrogram()
+  {
+  }
+
+  template <class _weight, class _vertex>
+  void t_kruskal<_weight, _vertex>::kruskal(typename std::vector<edge_t>::iterator first, typename std::vector<edge_t>::iterator last)
+  {
+    std::size_t n = this->m_uf.size();
+    for(; first != last && this->m_forest.size() + 1 < n; ++first)
+      {
+	vertex_t u = this->m_uf.find_set(std::get<0>(*first));
+	vertex_t v = this->m_uf.find_set(std::get<1>(*first));
+	if(u == v)
+	  continue;
+	merge_t merge;
+	merge.first = this->m_clusters[u];
+	merge.second = this->m_clusters[v];
+	merge.height = std::get<2>(*first);
+	vertex_t leader = this->m_uf.union_sets(u, v);
+	merge.size = vertex_t(this->m_uf.set_size(leader));
+	this->m_clusters[leader] = vertex_t(n + this->m_dendrogram.size());
+	this->m_dendrogram.push_back(merge);
+	this->m_forest.push_back(*first);
+      }
+  }
+
+  template <class _weight, class _vertex>
+  typename std::vector<typename t_kruskal<_weight, _vertex>::edge_t>::iterator t_kruskal<_weight, _vertex>::filter(typename std::vector<edge_t>::iterator first, typename std::vector<edge_t>::iterator last)
+  {
+    //the filter is skipped when less than half of a sample of the
+    //edges would be removed, as on sparse graphs it costs more finds
+    //than it saves
+    std::size_t m = std::size_t(last - first);
+    std::size_t k = std::min<std::size_t>(m, FILTER_SAMPLE);
+    std::size_t nb_connected = 0;
+    for(std::size_t i = 0; i < k; i++)
+      if(this->m_uf.find_set(std::get<0>(first[i * m / k])) == this->m_uf.find_set(std::get<1>(first[i * m / k])))
+	nb_connected++;
+    if(2 * nb_connected < k)
+      return last;
+
+    if(m < PARALLEL_FILTER || this->m_nb_threads == 1)
+      {
+	typename std::vector<edge_t>::iterator out = first;
+	for(; first != last; ++first)
+	  if(this->m_uf.find_set(std::get<0>(*first)) != this->m_uf.find_set(std::get<1>(*first)))
+	    *out++ = *first;
+	return out;
+      }
+
+    //the threads share the structure with finds without compression
+    const union_find_t& uf = this->m_uf;
+    std::vector<unsigned char> connected(m);
+    parallel_blocks(m, this->m_nb_threads, [&uf, &connected, first](std::size_t begin, std::size_t end, unsigned){
+	uf.same_set_batch(first + begin, first + end, connected.begin() + begin);
+      });
+
+    typename std::vector<edge_t>::iterator out = first;
+    for(std::size_t i = 0; i < m; i++)
+      if(!connected[i])
+	*out++ = first[i];
+    return out;
+  }
+
+  template <class _weight, class _vertex>
+  typename t_kruskal<_weight, _vertex>::weight_t t_kruskal<_weight, _vertex>::pivot(typename std::vector<edge_t>::const_iterator first, typename std::vector<edge_t>::const_iterator last)
+  {
+    std::size_t m = std::size_t(last - first);
+    std::size_t k = std::min<std::size_t>(m, 31);
+    std::vector<weight_t> sample(k);
+    for(std::size_t i = 0; i < k; i++)
+      sample[i] = std::get<2>(first[i * m / k]);
+    std::nth_element(sample.begin(), sample.begin() + k / 2, sample.end());
+    return sample[k / 2];
+  }
+
+  template <class _weight, class _vertex>
+  void t_kruskal<_weight, _vertex>::run(std::size_t n, std::vector<edge_t>& edges)
+  {
+    this->m_uf.clear();
+    this->m_uf.make_sets(n);
+    this->m_clusters.resize(n);
+    for(std::size_t u = 0; u < n; u++)
+      this->m_clusters[u] = vertex_t(u);
+    this->m_forest.clear();
+    this->m_dendrogram.clear();
+
+    //the ranges are processed by increasing weights, without recursion
+    std::vector<t_range> ranges;
+    ranges.push_back(t_range{0, edges.size(), false});
+    while(!ranges.empty() && this->m_forest.size() + 1 < n)
+      {
+	t_range range = ranges.back();
+	ranges.pop_back();
+	typename std::vector<edge_t>::iterator first = edges.begin() + range.begin;
+	typename std::vector<edge_t>::iterator last = edges.begin() + range.end;
+	if(range.filter)
+	  last = this->filter(first, last);
+	if(first == last)
+	  continue;
+
+	//the heavy half is empty when the pivot is the largest weight
+	typename std::vector<edge_t>::iterator middle = last;
+	if(std::size_t(last - first) > SORT_THRESHOLD)
+	  {
+	    weight_t p = pivot(first, last);
+	    middle = std::partition(first, last, [p](const edge_t& e){return std::get<2>(e) <= p;});
+	  }
+	if(middle == last)
+	  {
+	    std::sort(first, last, [](const edge_t& a, const edge_t& b){return std::get<2>(a) < std::get<2>(b);});
+	    this->kruskal(first, last);
+	    continue;
+	  }
+	ranges.push_back(t_range{std::size_t(middle - edges.begin()), std::size_t(last - edges.begin()), true});
+	ranges.push_back(t_range{std::size_t(first - edges.begin()), std::size_t(middle - edges.begin()), false});
+      }
+  }
+
+  template <class _weight, class _vertex>
+  const std::vector<typename t_kruskal<_weight, _vertex>::edge_t>& t_kruskal<_weight, _vertex>::forest(void)const
+  {
+    return this->m_forest;
+  }
+
+  template <class _weight, class _vertex>
+  const std::vector<typename t_kruskal<_weight, _vertex>::merge_t>& t_kruskal<_weight, _vertex>::dendrogram(void)const
+  {
+    return this->m_dendrogram;
+  }
+
+  template <class _weight, class _vertex>
+  typename t_kruskal<_weight, _vertex>::weight_t t_kruskal<_weight, _vertex>::total_weight(void)const
+  {
+    weight_t total = weight_t();
+    for(const edge_t& e : this->m_forest)
+      total += std::get<2>(e);
+    return total;
+  }
+
+  template <class _weight, class _vertex>
+  std::size_t t_kruskal<_weight, _vertex>::number_of_components(void)const
+  {
+    return this->m_uf.number_of_independent_sets();
+  }
+
+}//end namespace utils
+
+#endif
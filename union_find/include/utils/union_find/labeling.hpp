@@ -0,0 +1,412 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_LABELING_HPP_
+#define _UTILS_UNION_FIND_LABELING_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <utils/union_find.hpp>
+
+namespace utils{
+  /*
+    Connected component labeling of 2D images and 3D volumes : the
+    pixels (voxels) that are not zero are labeled from 1 to k by
+    connected component, in the order of their first pixel in memory,
+    and the background is labeled 0. The image is stored row by row,
+    then slice by slice, and the labels are written to a buffer of the
+    same layout given by the caller.
+
+    The labeling works on the runs of consecutive foreground pixels of
+    each row instead of the pixels, so that the Union-Find structures
+    have one vertex per run :
+
+    - the rows are split in one strip per thread, and each thread
+      extracts the runs of its rows, skipping 8 bytes at a time with
+      SWAR tests for images of bytes,
+    - each thread unions the overlapping runs of the neighbor rows
+      inside its strip, in its own Union-Find structure,
+    - the local sets and the runs overlapping across the borders of
+      the strips are merged in one Union-Find structure,
+    - the labels of the runs are given in order, and each thread
+      writes the labels of its rows.
+
+    Two runs of neighbor rows overlap if they share a column (4 and 6
+    connectivity) or if they share or touch a column by a corner (8
+    and 26 connectivity).
+
+    The labels must hold the number of components : std::overflow_error
+    is thrown, before any label is written, if there are more
+    components than the largest label_t.
+  */
+
+  template <class _label = std::uint32_t>
+  class t_labeling{
+
+    //Types
+
+  public:
+
+    typedef _label label_t;
+
+    enum connectivity_t{
+      CONNECTIVITY_4  = 4,//2D, by the sides
+      CONNECTIVITY_6  = 6,//3D, by the faces
+      CONNECTIVITY_8  = 8,//2D, by the sides and corners
+      CONNECTIVITY_26 = 26//3D, by the faces, edges and corners
+    };
+
+  private:
+
+    //a run of foreground pixels [begin, end) in a row
+    struct t_run{
+      std::uint32_t begin;
+      std::uint32_t end;
+    };
+
+    typedef t_union_find<false, t_vertex_index<std::uint32_t> > local_union_find_t;
+    typedef t_union_find<false>                                  global_union_find_t;
+
+    //Attributes
+
+  private:
+
+    unsigned                 m_nb_threads;
+    std::vector<t_run>       m_runs;//runs of all the rows
+    std::vector<std::size_t> m_rows;//first run of each row, and the number of runs
+    std::vector<label_t>     m_run_labels;//label of each run
+    std::size_t              m_nb_components;
+
+    //Constructors
+
+  public:
+
+    //nb_threads is the number of threads (0 for all the cores)
+    t_labeling(unsigned nb_threads = 0);
+
+    //Internal
+
+  private:
+
+    //returns the first foreground pixel of the row from x
+    template <class _pixel>
+    static std::size_t skip_background(const _pixel* row, std::size_t x, std::size_t width);
+
+    //returns the first background pixel of the row from x
+    template <class _pixel>
+    static std::size_t skip_foreground(const _pixel* row, std::size_t x, std::size_t width);
+
+    //appends the runs of the row to runs
+    template <class _pixel>
+    static void scan_row(const _pixel* row, std::size_t width, std::vector<t_run>& runs);
+
+    //fills the neighbor rows of the row r that come before it, and
+    //returns their number
+    static unsigned neighbor_rows(std::size_t r, std::size_t height, std::size_t depth, connectivity_t connectivity, std::size_t* rows);
+
+    //calls union_runs(i, j) on each pair of overlapping runs of two
+    //rows, extended by one pixel for the corners
+    template <class _union_runs>
+    static void overlap(const t_run* a, std::size_t na, const t_run* b, std::size_t nb, std::uint32_t extension, _union_runs union_runs);
+
+    //labels the rows of the depth slices of height rows, the
+    //connectivity being checked by the callers
+    template <class _pixel>
+    std::size_t label_rows(const _pixel* volume, std::size_t width, std::size_t height, std::size_t depth, connectivity_t connectivity, label_t* labels);
+
+    //Labeling
+
+  public:
+
+    //labels the 2D image of width x height pixels with 4 or 8
+    //connectivity, returns the number of components (O(n / #threads)),
+    //throws std::overflow_error if they do not fit in label_t
+    template <class _pixel>
+    std::size_t label(const _pixel* image, std::size_t width, std::size_t height, connectivity_t connectivity, label_t* labels);
+
+    //labels the 3D volume of width x height x depth voxels with 6 or
+    //26 connectivity, returns the number of components
+    //(O(n / #threads)), throws std::overflow_error if they do not fit
+    //in label_t
+    template <class _pixel>
+    std::size_t label(const _pixel* volume, std::size_t width, std::size_t height, std::size_t depth, connectivity_t connectivity, label_t* labels);
+
+    //returns the number of components of the last labeling (O(1))
+    std::size_t number_of_components(void)const;
+
+    //returns the number of runs of the last labeling (O(1))
+    std::size_t number_of_runs(void)const;
+
+  };//end class t_labeling
+
+  //Implementation
+
+  template <class _label>
+  t_labeling<_label>::t_labeling(unsigned nb_threads)
+    : m_nb_threads(number_of_threads(nb_threads)),
+      m_runs(),
+      m_rows(),
+      m_run_labels(),
+      m_nb_components(0)
+  {
+  }
+
+  template <class _label>
+  template <class _pixel>
+  std::size_t t_labeling<_label>::skip_background(const _pixel* row, std::size_t x, std::size_t width)
+  {
+    if(sizeof(_pixel) == 1)
+      for(std::uint64_t word; x + 8 <= width; x += 8)
+	{
+	  std::memcpy(&word, row + x, 8);
+	  if(word != 0)
+	    break;
+	}
+    while(x < width && row[x] == _pixel(0))
+      x++;
+    return x;
+  }
+
+  template <class _label>
+  template <class _pixel>
+  std::size_t t_labeling<_label>::skip_foreground(const _pixel* row, std::size_t x, std::size_t width)
+  {
+    //a word has a zero byte iff (word - 0x01..01) & ~word & 0x80..80
+    if(sizeof(_pixel) == 1)
+      for(std::uint64_t word; x + 8 <= width; x += 8)
+	{
+	  std::memcpy(&word, row + x, 8);
+	  if(((word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL) != 0)
+	    break;
+	}
+    while(x < width && row[x] != _pixel(0))
+      x++;
+    return x;
+  }
+
+  template <class _label>
+  template <class _pixel>
+  void t_labeling<_label>::scan_row(const _pixel* row, std::size_t width, std::vector<t_run>& runs)
+  {
+    for(std::size_t x = skip_background(row, 0, width); x < width; x = skip_background(row, x, width))
+      {
+	t_run run;
+	run.begin = std::uint32_t(x);
+	x = skip_foreground(row, x, width);
+	run.end = std::uint32_t(x);
+	runs.push_back(run);
+      }
+  }
+
+  template <class _label>
+  unsigned t_labeling<_label>::neighbor_rows(std::size_t r, std::size_t height, std::size_t depth, connectivity_t connectivity, std::size_t* rows)
+  {
+    std::size_t y = r % height;
+    std::size_t z = r / height;
+    unsigned n = 0;
+    if(y > 0)
+      rows[n++] = r - 1;
+    if(depth > 1 && z > 0)
+      {
+	rows[n++] = r - height;
+	if(connectivity == CONNECTIVITY_26)
+	  {
+	    if(y > 0)
+	      rows[n++] = r - height - 1;
+	    if(y + 1 < height)
+	      rows[n++] = r - height + 1;
+	  }
+      }
+    return n;
+  }
+
+  template <class _label>
+  template <class _union_runs>
+  void t_labeling<_label>::overlap(const t_run* a, std::size_t na, const t_run* b, std::size_t nb, std::uint32_t extension, _union_runs union_runs)
+  {
+    //both lists are sorted, the run ending first cannot overlap the
+    //next runs of the other row
+    std::size_t i = 0, j = 0;
+    while(i < na && j < nb)
+      {
+	if(a[i].begin < b[j].end + extension && b[j].begin < a[i].end + extension)
+	  union_runs(i, j);
+	if(a[i].end < b[j].end)
+	  i++;
+	else
+	  j++;
+      }
+  }
+
+  template <class _label>
+  template <class _pixel>
+  std::size_t t_labeling<_label>::label(const _pixel* image, std::size_t width, std::size_t height, connectivity_t connectivity, label_t* labels)
+  {
+    assert(connectivity == CONNECTIVITY_4 || connectivity == CONNECTIVITY_8);
+    return this->label_rows(image, width, height, 1, connectivity, labels);
+  }
+
+  template <class _label>
+  template <class _pixel>
+  std::size_t t_labeling<_label>::label(const _pixel* volume, std::size_t width, std::size_t height, std::size_t depth, connectivity_t connectivity, label_t* labels)
+  {
+    assert(connectivity == CONNECTIVITY_6 || connectivity == CONNECTIVITY_26);
+    return this->label_rows(volume, width, height, depth, connectivity, labels);
+  }
+
+  template <class _label>
+  template <class _pixel>
+  std::size_t t_labeling<_label>::label_rows(const _pixel* volume, std::size_t width, std::size_t height, std::size_t depth, connectivity_t connectivity, label_t* labels)
+  {
+    assert(width < std::size_t(std::numeric_limits<std::uint32_t>::max()));
+
+    std::size_t nb_rows = height * depth;
+    unsigned nb_threads = this->m_nb_threads;
+    std::uint32_t extension = (connectivity == CONNECTIVITY_8 || connectivity == CONNECTIVITY_26) ? 1 : 0;
+    this->m_nb_components = 0;
+    this->m_runs.clear();
+    this->m_rows.assign(nb_rows + 1, 0);
+    if(nb_rows == 0 || width == 0)
+      return 0;
+
+    //runs of each strip, the rows being numbered from the start of the
+    //strip
+    std::vector<std::vector<t_run> > strip_runs(nb_threads);
+    std::vector<std::size_t> strip_begin(nb_threads + 1, nb_rows);
+    std::vector<std::size_t>& rows = this->m_rows;
+    parallel_blocks(nb_rows, nb_threads, [volume, width, &strip_runs, &strip_begin, &rows](std::size_t begin, std::size_t end, unsigned t){
+	strip_begin[t] = begin;
+	for(std::size_t r = begin; r < end; r++)
+	  {
+	    rows[r] = strip_runs[t].size();
+	    scan_row(volume + r * width, width, strip_runs[t]);
+	  }
+      });
+    for(unsigned t = nb_threads; t > 0; t--)
+      strip_begin[t - 1] = std::min(strip_begin[t - 1], strip_begin[t]);
+
+    //global indices of the runs
+    std::vector<std::size_t> strip_offset(nb_threads + 1, 0);
+    for(unsigned t = 0; t < nb_threads; t++)
+      strip_offset[t + 1] = strip_offset[t] + strip_runs[t].size();
+    std::size_t nb_runs = strip_offset[nb_threads];
+    this->m_runs.resize(nb_runs);
+    std::vector<t_run>& runs = this->m_runs;
+    parallel_blocks(nb_rows, nb_threads, [&runs, &rows, &strip_runs, &strip_offset](std::size_t begin, std::size_t end, unsigned t){
+	for(std::size_t r = begin; r < end; r++)
+	  rows[r] += strip_offset[t];
+	std::copy(strip_runs[t].begin(), strip_runs[t].end(), runs.begin() + strip_offset[t]);
+	std::vector<t_run>().swap(strip_runs[t]);
+      });
+    rows[nb_rows] = nb_runs;
+
+    //local unions inside each strip, the leader of each run being
+    //stored as a global index
+    std::vector<std::size_t> leaders(nb_runs);
+    parallel_blocks(nb_rows, nb_threads, [height, depth, connectivity, extension, &runs, &rows, &leaders, &strip_offset](std::size_t begin, std::size_t end, unsigned t){
+	std::size_t offset = strip_offset[t];
+	assert(strip_offset[t + 1] - offset < std::size_t(std::numeric_limits<std::uint32_t>::max()));
+	local_union_find_t uf;
+	uf.make_sets(strip_offset[t + 1] - offset);
+	std::size_t neighbors[4];
+	for(std::size_t r = begin; r < end; r++)
+	  for(unsigned k = 0, nb_neighbors = neighbor_rows(r, height, depth, connectivity, neighbors); k < nb_neighbors; k++)
+	    {
+	      std::size_t nr = neighbors[k];
+	      if(nr < begin)
+		continue;
+	      std::size_t a = rows[nr], b = rows[r];
+	      overlap(runs.data() + a, rows[nr + 1] - a, runs.data() + b, rows[r + 1] - b, extension, [&uf, a, b, offset](std::size_t i, std::size_t j){
+		  uf.union_sets(std::uint32_t(a + i - offset), std::uint32_t(b + j - offset));
+		});
+	    }
+	for(std::size_t i = offset; i < strip_offset[t + 1]; i++)
+	  leaders[i] = offset + uf.find_set(std::uint32_t(i - offset));
+      });
+
+    //merge of the strips and of the runs across their borders
+    global_union_find_t uf;
+    uf.make_sets(nb_runs);
+    for(std::size_t i = 0; i < nb_runs; i++)
+      if(leaders[i] != i)
+	uf.union_sets(leaders[i], i);
+    std::vector<std::size_t>().swap(leaders);
+    std::size_t neighbors[4];
+    //the neighbor rows are at most height + 1 rows before
+    for(unsigned t = 1; t < nb_threads; t++)
+      for(std::size_t r = strip_begin[t]; r < std::min(strip_begin[t + 1], strip_begin[t] + height + 2); r++)
+	for(unsigned k = 0, nb_neighbors = neighbor_rows(r, height, depth, connectivity, neighbors); k < nb_neighbors; k++)
+	  if(neighbors[k] < strip_begin[t])
+	    {
+	      std::size_t nr = neighbors[k];
+	      std::size_t a = rows[nr], b = rows[r];
+	      overlap(runs.data() + a, rows[nr + 1] - a, runs.data() + b, rows[r + 1] - b, extension, [&uf, a, b](std::size_t i, std::size_t j){
+		  uf.union_sets(a + i, b + j);
+		});
+	    }
+
+    //labels in the order of the first run of each component, a label
+    //after the largest label_t would wrap to the background
+    std::vector<label_t>& run_labels = this->m_run_labels;
+    run_labels.assign(nb_runs, label_t(0));
+    std::size_t k = 0;
+    const std::size_t max_label = std::size_t(std::numeric_limits<label_t>::max());
+    for(std::size_t i = 0; i < nb_runs; i++)
+      {
+	std::size_t leader = uf.find_set(i);
+	if(run_labels[leader] == label_t(0))
+	  {
+	    if(k == max_label)
+	      throw std::overflow_error("t_labeling : more components than labels");
+	    run_labels[leader] = label_t(++k);
+	  }
+	run_labels[i] = run_labels[leader];
+      }
+    this->m_nb_components = k;
+
+    //labels of the pixels
+    parallel_blocks(nb_rows, nb_threads, [width, labels, &runs, &rows, &run_labels](std::size_t begin, std::size_t end, unsigned){
+	for(std::size_t r = begin; r < end; r++)
+	  {
+	    label_t* row = labels + r * width;
+	    std::fill(row, row + width, label_t(0));
+	    for(std::size_t i = rows[r]; i < rows[r + 1]; i++)
+	      std::fill(row + runs[i].begin, row + runs[i].end, run_labels[i]);
+	  }
+      });
+
+    return k;
+  }
+
+  template <class _label>
+  std::size_t t_labeling<_label>::number_of_components(void)const
+  {
+    return this->m_nb_components;
+  }
+
+  template <class _label>
+  std::size_t t_labeling<_label>::number_of_runs(void)const
+  {
+    return this->m_runs.size();
+  }
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,347 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_MAPPED_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_MAPPED_UNION_FIND_HPP_
+
+#include <cassert>
+#include <limits>
+#include <utils/union_find.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils{
+  /*
+    A Union-Find structure working in place on a file saved by
+    t_union_find::save, mapped in memory with mmap (POSIX only). Opening
+    the file reads the parents once, to refuse a file whose finds would
+    leave the mapping, but nothing is copied : the structure is used in
+    place, instead of being read into arrays.
+
+    The policies are the ones of the t_union_find that saved the file.
+    Two modes are available :
+    - READ_ONLY : the file is mapped read-only and shared, find_set
+      does no path compression and union_sets is not allowed,
+    - COPY_ON_WRITE : the file is mapped privately, the pages that are
+      modified by find_set and union_sets are copied in memory and the
+      file is never modified.
+
+    The number of vertices is fixed, and the rewind log is ignored.
+    The member lists, if any, are not updated, so independent_set
+    scans all the vertices.
+  */
+
+  template <class... _policies>
+  class t_mapped_union_find{
+
+    //Types
+
+  public:
+
+    typedef t_union_find<false, _policies...>     union_find_t;
+    typedef typename union_find_t::vertex_t      vertex_t;
+    typedef typename union_find_t::compression_t compression_t;
+    typedef typename union_find_t::linking_t     linking_t;
+
+    enum mode_t{
+      READ_ONLY,
+      COPY_ON_WRITE
+    };
+
+    //returned by union_sets in READ_ONLY mode
+    static const vertex_t NONE;
+
+  private:
+
+    typedef typename linking_t::template weight<vertex_t>::type                                                                  weight_t;
+    typedef typename union_find_t::weight_storage_t::template storage<vertex_t, weight_t, linking_t::USES_WEIGHT>::view_type storage_t;
+
+    //Attributes
+
+  private:
+
+    void*       m_address;
+    std::size_t m_length;
+    mode_t      m_mode;
+    storage_t   m_storage;
+    std::size_t m_nb_cc;
+
+    //Constructors
+
+  public:
+
+    t_mapped_union_find(void);
+
+    ~t_mapped_union_find(void);
+
+    t_mapped_union_find(const t_mapped_union_find&) = delete;
+
+    t_mapped_union_find& operator=(const t_mapped_union_find&) = delete;
+
+    //Internal
+
+  private:
+
+    //Check that u is a vertex of this structure.
+    bool is_valid(vertex_t u)const;
+
+    //Find the leader of u without path compression.
+    vertex_t leader(vertex_t u)const;
+
+    //Mapping
+
+  public:
+
+    //maps the file in memory, returns false on failure or on a corrupt
+    //file (O(n) to check the parents)
+    bool open(const char* path, mode_t mode = READ_ONLY);
+
+    //unmaps the file, the changes are lost (O(1))
+    void close(void);
+
+    //returns true iff a file is mapped (O(1))
+    bool is_open(void)const;
+
+    //Base operations
+
+  public:
+
+    //finds the leader of the set containing u, with path compression
+    //in COPY_ON_WRITE mode (~O(1))
+    vertex_t find_set(vertex_t u);
+
+    //unions two sets if they are disjoint, in COPY_ON_WRITE mode
+    //only, returns NONE in READ_ONLY mode (~O(1))
+    vertex_t union_sets(vertex_t u, vertex_t v);
+
+    //returns true iff u and v are in the same set (~O(1))
+    bool same_set(vertex_t u, vertex_t v);
+
+    //Independent sets
+
+  public:
+
+    //returns true iff there is no vertex in the structure (O(1))
+    bool empty(void)const;
+
+    //returns the number of vertices in the structure (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of independent sets in the structure (O(1))
+    std::size_t number_of_independent_sets(void)const;
+
+    //fills the input container with all the leaders (O(n))
+    template<class _output_iterator>
+    _output_iterator leaders(_output_iterator out);
+
+    //fills the input container with all the vertices in the set
+    //containing u (O(n))
+    template<class _output_iterator>
+    _output_iterator independent_set(vertex_t u, _output_iterator out);
+
+    //returns an immutable snapshot of the independent sets
+    //(O(n / #threads))
+    t_frozen_union_find<vertex_t> freeze(unsigned nb_threads = 0)const;
+
+  };//end class t_mapped_union_find
+
+  //Implementation
+
+  template <class... _policies>
+  const typename t_mapped_union_find<_policies...>::vertex_t t_mapped_union_find<_policies...>::NONE = std::numeric_limits<vertex_t>::max();
+
+  template <class... _policies>
+  t_mapped_union_find<_policies...>::t_mapped_union_find(void)
+    : m_address(nullptr),
+      m_length(0),
+      m_mode(READ_ONLY),
+      m_storage(),
+      m_nb_cc(0)
+  {
+  }
+
+  template <class... _policies>
+  t_mapped_union_find<_policies...>::~t_mapped_union_find(void)
+  {
+    this->close();
+  }
+
+  template <class... _policies>
+  bool t_mapped_union_find<_policies...>::is_valid(vertex_t u)const
+  {
+    return u < this->size();
+  }
+
+  template <class... _policies>
+  typename t_mapped_union_find<_policies...>::vertex_t t_mapped_union_find<_policies...>::leader(vertex_t u)const
+  {
+    while(u != this->m_storage.parent(u))
+      u = this->m_storage.parent(u);
+    return u;
+  }
+
+  template <class... _policies>
+  bool t_mapped_union_find<_policies...>::open(const char* path, mode_t mode)
+  {
+    this->close();
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0)
+      return false;
+
+    //check the header before mapping the whole file
+    t_union_find_file_header header;
+    struct stat status;
+    bool ok = ::pread(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header))
+      && header.same_layout(union_find_t::file_header(0, 0, 0))
+      && ::fstat(fd, &status) == 0
+      && header.fits(std::uint64_t(status.st_size))
+      && header.size <= union_find_t::max_size();
+    void* address = MAP_FAILED;
+    if(ok)
+      address = ::mmap(nullptr, std::size_t(header.log_offset()), mode == READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE,
+		       mode == READ_ONLY ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(address == MAP_FAILED)
+      return false;
+
+    this->m_address = address;
+    this->m_length = std::size_t(header.log_offset());
+    this->m_mode = mode;
+    char* base = static_cast<char*>(address);
+    this->m_storage = storage_t(reinterpret_cast<vertex_t*>(base + header.parents_offset()),
+				header.weight_bytes > 0 ? reinterpret_cast<weight_t*>(base + header.weights_offset()) : nullptr,
+				std::size_t(header.size));
+    this->m_nb_cc = std::size_t(header.nb_cc);
+
+    //the finds must stay in the mapping
+    const storage_t& storage = this->m_storage;
+    if(!valid_union_find_forest(this->size(), this->m_nb_cc, [&storage](std::size_t u){return storage.parent(vertex_t(u));}))
+      {
+	this->close();
+	return false;
+      }
+    return true;
+  }
+
+  template <class... _policies>
+  void t_mapped_union_find<_policies...>::close(void)
+  {
+    if(this->m_address != nullptr)
+      ::munmap(this->m_address, this->m_length);
+    this->m_address = nullptr;
+    this->m_length = 0;
+    this->m_storage = storage_t();
+    this->m_nb_cc = 0;
+  }
+
+  template <class... _policies>
+  bool t_mapped_union_find<_policies...>::is_open(void)const
+  {
+    return this->m_address != nullptr;
+  }
+
+  template <class... _policies>
+  typename t_mapped_union_find<_policies...>::vertex_t t_mapped_union_find<_policies...>::find_set(vertex_t u)
+  {
+    assert(this->is_valid(u));
+
+    if(this->m_mode == READ_ONLY)
+      return this->leader(u);
+    return compression_t::find(this->m_storage, u, [](vertex_t){});
+  }
+
+  template <class... _policies>
+  typename t_mapped_union_find<_policies...>::vertex_t t_mapped_union_find<_policies...>::union_sets(vertex_t u, vertex_t v)
+  {
+    assert(this->is_valid(u));
+    assert(this->is_valid(v));
+
+    //the shared mapping is read-only
+    if(this->m_mode == READ_ONLY)
+      return NONE;
+
+    u = this->find_set(u);
+    v = this->find_set(v);
+    if(u != v)
+      {
+	this->m_nb_cc--;
+	bool changed;
+	vertex_t leader = linking_t::link(this->m_storage, u, v, changed);
+	if(leader != u)
+	  std::swap(u, v);
+	this->m_storage.set_parent(v, u);
+      }
+    return u;
+  }
+
+  template <class... _policies>
+  bool t_mapped_union_find<_policies...>::same_set(vertex_t u, vertex_t v)
+  {
+    return this->find_set(u) == this->find_set(v);
+  }
+
+  template <class... _policies>
+  bool t_mapped_union_find<_policies...>::empty(void)const
+  {
+    return this->size() == 0;
+  }
+
+  template <class... _policies>
+  std::size_t t_mapped_union_find<_policies...>::size(void)const
+  {
+    return this->m_storage.size();
+  }
+
+  template <class... _policies>
+  std::size_t t_mapped_union_find<_policies...>::number_of_independent_sets(void)const
+  {
+    return this->m_nb_cc;
+  }
+
+  template <class... _policies>
+  template<class _output_iterator>
+  _output_iterator t_mapped_union_find<_policies...>::leaders(_output_iterator out)
+  {
+    for(vertex_t u = 0; u < this->size(); u++)
+      if(u == this->m_storage.parent(u))
+	*out = u;
+    return out;
+  }
+
+  template <class... _policies>
+  template<class _output_iterator>
+  _output_iterator t_mapped_union_find<_policies...>::independent_set(vertex_t u, _output_iterator out)
+  {
+    assert(this->is_valid(u));
+
+    u = this->find_set(u);
+    for(vertex_t v = 0; v < this->size(); v++)
+      if(u == this->find_set(v))
+	*out = v;
+    return out;
+  }
+
+  template <class... _policies>
+  t_frozen_union_find<typename t_mapped_union_find<_policies...>::vertex_t> t_mapped_union_find<_policies...>::freeze(unsigned nb_threads)const
+  {
+    return t_frozen_union_find<vertex_t>(this->size(), [this](vertex_t u){return this->leader(u);}, nb_threads);
+  }
+
+}//end namespace utils
+
+#endif
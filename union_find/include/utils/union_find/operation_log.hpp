@@ -0,0 +1,204 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_OPERATION_LOG_HPP_
+#define _UTILS_UNION_FIND_OPERATION_LOG_HPP_
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <utils/union_find/allocator.hpp>
+
+namespace utils{
+  /*
+    Log of the operations of a Union-Find structure, used for the
+    rewind feature. The entries are stored in one contiguous buffer of
+    words of the width of the vertex indices. Each entry is made of
+    its operands followed by a trailer word packing the operation tag
+    (2 bits), a flag (1 bit) and the number of operands, so that the
+    log is read backward from its end :
+
+    - make set   : the trailer only, the vertex being the last one,
+    - find set   : the path followed by the find, each vertex of the
+                   path having the next one as parent before the find,
+    - union sets : the new leader, the linked leader and, if needed,
+                   its weight; the flag tells if the weight of the new
+                   leader was changed.
+
+    The operation tags take the values of t_union_find::operation_t.
+  */
+
+  template <class _word, class _allocator = std::allocator<_word> >
+  class t_operation_log{
+
+    //Types
+
+  public:
+
+    typedef _word word_t;
+
+    static const unsigned TAG_BITS  = 2;
+    static const unsigned FLAG_BIT  = 2;
+    static const unsigned LENGTH_SHIFT = 3;
+    static const unsigned FIND_SET_TAG = 2;
+
+    //an entry read from the end of the log
+    struct entry_t{
+      unsigned      tag;//the operation
+      bool          flag;//the flag of the operation
+      std::size_t   length;//the number of operands
+      const word_t* operands;//the operands of the entry
+    };
+
+    //Attributes
+
+  private:
+
+    typename t_allocator_vector<word_t, _allocator>::type m_words;
+    std::size_t                                           m_path_begin;//start of the find set entry being recorded
+
+    //Constructors
+
+  public:
+
+    t_operation_log(void) : m_words(), m_path_begin(0) {}
+
+    //Internal
+
+  private:
+
+    static std::size_t max_length(void){return std::numeric_limits<word_t>::max() >> LENGTH_SHIFT;}
+
+    void push_trailer(unsigned tag, bool flag, std::size_t length)
+    {
+      assert(length <= max_length());
+      this->m_words.push_back(word_t((word_t(length) << LENGTH_SHIFT) | (word_t(flag) << FLAG_BIT) | word_t(tag)));
+    }
+
+    //Operations
+
+  public:
+
+    //returns true iff there is no entry (O(1))
+    bool empty(void)const{return this->m_words.empty();}
+
+    //returns the number of words in the log (O(1))
+    std::size_t size(void)const{return this->m_words.size();}
+
+    //returns the memory allocated by the log in bytes (O(1))
+    std::size_t memory(void)const{return this->m_words.capacity() * sizeof(word_t);}
+
+    //allocates the memory for n words (O(n))
+    void reserve(std::size_t n){this->m_words.reserve(n);}
+
+    //removes all entries (O(1))
+    void clear(void){this->m_words.clear();}
+
+    //writes all the words at the position of the file (O(n))
+    bool write(std::FILE* file)const
+    {
+      return std::fwrite(this->m_words.data(), sizeof(word_t), this->m_words.size(), file) == this->m_words.size();
+    }
+
+    //replaces the log by n words read at the position of the file
+    //(O(n))
+    bool read(std::FILE* file, std::size_t n)
+    {
+      this->m_words.resize(n);
+      if(std::fread(this->m_words.data(), sizeof(word_t), n, file) == n)
+	return true;
+      this->m_words.clear();
+      return false;
+    }
+
+    //records an operation with no operand
+    void push(unsigned tag, bool flag)
+    {
+      this->push_trailer(tag, flag, 0);
+    }
+
+    //records an operation with two or three operands
+    void push(unsigned tag, bool flag, word_t u, word_t v)
+    {
+      this->m_words.push_back(u);
+      this->m_words.push_back(v);
+      this->push_trailer(tag, flag, 2);
+    }
+
+    void push(unsigned tag, bool flag, word_t u, word_t v, word_t w)
+    {
+      this->m_words.push_back(u);
+      this->m_words.push_back(v);
+      this->m_words.push_back(w);
+      this->push_trailer(tag, flag, 3);
+    }
+
+    //starts recording the path of a find set
+    void begin_path(void)
+    {
+      this->m_path_begin = this->size();
+    }
+
+    //adds a vertex to the path of the find set, splitting too long
+    //paths in several entries sharing one vertex
+    void push_path(word_t u)
+    {
+      if(this->size() - this->m_path_begin == max_length())
+	{
+	  word_t last = this->m_words.back();
+	  this->push_trailer(FIND_SET_TAG, false, max_length());
+	  this->m_path_begin = this->size();
+	  this->m_words.push_back(last);
+	}
+      this->m_words.push_back(u);
+    }
+
+    //ends recording the path of a find set, the path is dropped if no
+    //parent was changed
+    void end_path(void)
+    {
+      std::size_t length = this->size() - this->m_path_begin;
+      if(length < 2)
+	this->m_words.resize(this->m_path_begin);
+      else
+	this->push_trailer(FIND_SET_TAG, false, length);
+    }
+
+    //reads the last entry (O(1))
+    entry_t back(void)const
+    {
+      assert(!this->empty());
+      word_t trailer = this->m_words.back();
+      entry_t entry;
+      entry.tag = unsigned(trailer & ((word_t(1) << TAG_BITS) - 1));
+      entry.flag = ((trailer >> FLAG_BIT) & 1) != 0;
+      entry.length = std::size_t(trailer >> LENGTH_SHIFT);
+      entry.operands = this->m_words.data() + this->m_words.size() - 1 - entry.length;
+      return entry;
+    }
+
+    //removes the last entry (O(1))
+    void pop_back(void)
+    {
+      this->m_words.resize(this->m_words.size() - 1 - this->back().length);
+    }
+
+  };//end class t_operation_log
+
+}//end namespace utils
+
+#endif
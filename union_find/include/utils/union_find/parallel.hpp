@@ -0,0 +1,70 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_PARALLEL_HPP_
+#define _UTILS_UNION_FIND_PARALLEL_HPP_
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace utils{
+  /*
+    Fork-join helpers shared by the parallel algorithms of the
+    Union-Find package. The range [0, n) is split into one contiguous
+    block per thread, and the calling thread processes the first
+    block itself.
+  */
+
+  //returns the number of threads to use, 0 meaning all the cores
+  inline unsigned number_of_threads(unsigned nb_threads)
+  {
+    if(nb_threads == 0)
+      nb_threads = std::thread::hardware_concurrency();
+    return std::max(1u, nb_threads);
+  }
+
+  //calls f(begin, end, thread) on one block of [0, n) per thread
+  template <class _function>
+  void parallel_blocks(std::size_t n, unsigned nb_threads, _function f)
+  {
+    nb_threads = (unsigned)std::min<std::size_t>(number_of_threads(nb_threads), std::max<std::size_t>(n, 1));
+    std::size_t block = (n + nb_threads - 1) / nb_threads;
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 1; t < nb_threads; t++)
+      {
+	std::size_t begin = std::min(n, t * block);
+	std::size_t end = std::min(n, begin + block);
+	threads.push_back(std::thread(f, begin, end, t));
+      }
+    f(std::size_t(0), std::min(n, block), 0u);
+    for(std::thread& thread : threads)
+      thread.join();
+  }
+
+  //calls f(i) for each i in [0, n) using several threads
+  template <class _function>
+  void parallel_for(std::size_t n, unsigned nb_threads, _function f)
+  {
+    parallel_blocks(n, nb_threads, [&f](std::size_t begin, std::size_t end, unsigned){
+	for(std::size_t i = begin; i < end; i++)
+	  f(i);
+      });
+  }
+
+}//end namespace utils
+
+#endif
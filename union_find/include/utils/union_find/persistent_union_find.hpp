@@ -0,0 +1,297 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_PERSISTENT_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_PERSISTENT_UNION_FIND_HPP_
+
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace utils{
+  /*
+    A partially persistent Union-Find structure : every past version
+    stays readable, without copying the arrays nor rewinding.
+
+    The version is the number of calls to union_sets so far, so that
+    version t is the state after the t-th union. A leader only gets a
+    parent once, when it is linked, so each vertex stores its parent
+    and the version of its link. The linking is done by rank and
+    without path compression, hence the trees have a height in
+    O(log n), and a find in a past version follows the parents linked
+    up to that version only :
+
+    - connected_at(u, v, t) tells if u and v were in the same set in
+      the version t (O(log n)),
+    - first_connected_time(u, v) returns the first version in which u
+      and v are in the same set, or NEVER (O(log n)).
+
+    The vertices created after a version are singletons in it.
+  */
+
+  template <class _vertex = std::size_t>
+  class t_persistent_union_find{
+
+    //Types
+
+  public:
+
+    typedef _vertex     vertex_t;
+    typedef std::size_t version_t;
+
+    static const version_t NEVER = std::numeric_limits<version_t>::max();
+
+    //Attributes
+
+  private:
+
+    std::vector<vertex_t>      m_parents;
+    std::vector<version_t>     m_times;//version of the link of each vertex, NEVER for the leaders
+    std::vector<unsigned char> m_ranks;
+    std::size_t                m_nb_cc;
+    version_t                  m_version;
+
+    //Constructors
+
+  public:
+
+    t_persistent_union_find(void);
+
+    //Internal
+
+  private:
+
+    //Check that u is a vertex of this structure.
+    bool is_valid(vertex_t u)const;
+
+    //Base operations
+
+  public:
+
+    //removes all the vertices and versions (O(1))
+    void clear(void);
+
+    //makes a new set containing one new vertex, returned (O(1))
+    vertex_t make_set(void);
+
+    //makes n sets of one vertex (O(n))
+    void make_sets(std::size_t n);
+
+    //finds the leader of the set containing u in the current version
+    //(O(log n))
+    vertex_t find_set(vertex_t u)const;
+
+    //unions the sets of u and v, returns the leader of the union, and
+    //creates a new version (O(log n))
+    vertex_t union_sets(vertex_t u, vertex_t v);
+
+    //returns true iff u and v are in the same set (O(log n))
+    bool same_set(vertex_t u, vertex_t v)const;
+
+    //Versions
+
+  public:
+
+    //returns the current version, i.e. the number of unions (O(1))
+    version_t version(void)const;
+
+    //finds the leader of the set containing u in the version t
+    //(O(log n))
+    vertex_t find_set(vertex_t u, version_t t)const;
+
+    //returns true iff u and v were in the same set in the version t
+    //(O(log n))
+    bool connected_at(vertex_t u, vertex_t v, version_t t)const;
+
+    //returns the first version where u and v are in the same set,
+    //NEVER if they are not in the current version (O(log n))
+    version_t first_connected_time(vertex_t u, vertex_t v)const;
+
+    //Independent sets
+
+  public:
+
+    //returns true iff there is no vertex in the structure (O(1))
+    bool empty(void)const;
+
+    //returns the number of vertices in the structure (O(1))
+    std::size_t size(void)const;
+
+    //returns the number of independent sets in the current version
+    //(O(1))
+    std::size_t number_of_independent_sets(void)const;
+
+  };//end class t_persistent_union_find
+
+  //Implementation
+
+  template <class _vertex>
+  const typename t_persistent_union_find<_vertex>::version_t t_persistent_union_find<_vertex>::NEVER;
+
+  template <class _vertex>
+  t_persistent_union_find<_vertex>::t_persistent_union_find(void)
+    : m_parents(),
+      m_times(),
+      m_ranks(),
+      m_nb_cc(0),
+      m_version(0)
+  {
+  }
+
+  template <class _vertex>
+  bool t_persistent_union_find<_vertex>::is_valid(vertex_t u)const
+  {
+    return u < this->size();
+  }
+
+  template <class _vertex>
+  void t_persistent_union_find<_vertex>::clear(void)
+  {
+    this->m_parents.clear();
+    this->m_times.clear();
+    this->m_ranks.clear();
+    this->m_nb_cc = 0;
+    this->m_version = 0;
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::vertex_t t_persistent_union_find<_vertex>::make_set(void)
+  {
+    vertex_t u = vertex_t(this->size());
+    this->m_parents.push_back(u);
+    this->m_times.push_back(NEVER);
+    this->m_ranks.push_back(0);
+    this->m_nb_cc++;
+    return u;
+  }
+
+  template <class _vertex>
+  void t_persistent_union_find<_vertex>::make_sets(std::size_t n)
+  {
+    this->m_parents.reserve(this->size() + n);
+    this->m_times.reserve(this->size() + n);
+    this->m_ranks.reserve(this->size() + n);
+    for(std::size_t i = 0; i < n; i++)
+      this->make_set();
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::vertex_t t_persistent_union_find<_vertex>::find_set(vertex_t u)const
+  {
+    assert(this->is_valid(u));
+
+    while(this->m_parents[u] != u)
+      u = this->m_parents[u];
+    return u;
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::vertex_t t_persistent_union_find<_vertex>::union_sets(vertex_t u, vertex_t v)
+  {
+    u = this->find_set(u);
+    v = this->find_set(v);
+    this->m_version++;
+    if(u != v)
+      {
+	if(this->m_ranks[u] < this->m_ranks[v])
+	  std::swap(u, v);
+	else if(this->m_ranks[u] == this->m_ranks[v])
+	  this->m_ranks[u]++;
+	this->m_parents[v] = u;
+	this->m_times[v] = this->m_version;
+	this->m_nb_cc--;
+      }
+    return u;
+  }
+
+  template <class _vertex>
+  bool t_persistent_union_find<_vertex>::same_set(vertex_t u, vertex_t v)const
+  {
+    return this->find_set(u) == this->find_set(v);
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::version_t t_persistent_union_find<_vertex>::version(void)const
+  {
+    return this->m_version;
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::vertex_t t_persistent_union_find<_vertex>::find_set(vertex_t u, version_t t)const
+  {
+    assert(this->is_valid(u));
+
+    //the link versions increase along a path, the walk stops at the
+    //first link after t
+    while(this->m_times[u] <= t && this->m_parents[u] != u)
+      u = this->m_parents[u];
+    return u;
+  }
+
+  template <class _vertex>
+  bool t_persistent_union_find<_vertex>::connected_at(vertex_t u, vertex_t v, version_t t)const
+  {
+    return this->find_set(u, t) == this->find_set(v, t);
+  }
+
+  template <class _vertex>
+  typename t_persistent_union_find<_vertex>::version_t t_persistent_union_find<_vertex>::first_connected_time(vertex_t u, vertex_t v)const
+  {
+    assert(this->is_valid(u));
+    assert(this->is_valid(v));
+
+    //climb from the endpoint linked first until both paths meet : the
+    //last link followed is the union that connected u and v
+    version_t t = 0;
+    while(u != v)
+      {
+	if(this->m_times[u] == NEVER && this->m_times[v] == NEVER)
+	  return NEVER;
+	if(this->m_times[u] < this->m_times[v])
+	  {
+	    t = this->m_times[u];
+	    u = this->m_parents[u];
+	  }
+	else
+	  {
+	    t = this->m_times[v];
+	    v = this->m_parents[v];
+	  }
+      }
+    return t;
+  }
+
+  template <class _vertex>
+  bool t_persistent_union_find<_vertex>::empty(void)const
+  {
+    return this->size() == 0;
+  }
+
+  template <class _vertex>
+  std::size_t t_persistent_union_find<_vertex>::size(void)const
+  {
+    return this->m_parents.size();
+  }
+
+  template <class _vertex>
+  std::size_t t_persistent_union_find<_vertex>::number_of_independent_sets(void)const
+  {
+    return this->m_nb_cc;
+  }
+
+}//end namespace utils
+
+#endif
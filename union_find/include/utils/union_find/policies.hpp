@@ -0,0 +1,747 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_POLICIES_HPP_
+#define _UTILS_UNION_FIND_POLICIES_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <utils/union_find/allocator.hpp>
+#include <utils/union_find/operation_log.hpp>
+#include <utils/union_find/spilling_log.hpp>
+#include <utils/union_find/storage.hpp>
+#include <utils/union_find/stats.hpp>
+
+namespace utils{
+  /*
+    Policies customizing the Union-Find structure t_union_find. They
+    are passed as template arguments after the rewind tag, in any
+    order, and each policy not given takes its default value :
+
+    t_union_find<true, t_path_halving, t_link_by_size> uf;
+
+    Each policy declares its category, so that t_select_policy can
+    find the policy of a category among the template arguments.
+  */
+
+  //Categories
+
+  struct t_compression_policy_tag{};
+  struct t_linking_policy_tag{};
+  struct t_vertex_index_policy_tag{};
+  struct t_weight_storage_policy_tag{};
+  struct t_member_policy_tag{};
+  struct t_reset_policy_tag{};
+  struct t_aggregate_policy_tag{};
+  struct t_removal_policy_tag{};
+  struct t_stats_policy_tag{};
+  struct t_allocator_policy_tag{};
+  struct t_log_policy_tag{};
+
+  //Selection of the policy of a category, or the default one.
+
+  template <class _category, class _default, class... _policies>
+  struct t_select_policy{
+    typedef _default type;
+  };
+
+  template <class _category, class _default, class _policy, class... _policies>
+  struct t_select_policy<_category, _default, _policy, _policies...>{
+    typedef typename std::conditional<std::is_same<typename _policy::policy_category, _category>::value,
+				      _policy,
+				      typename t_select_policy<_category, _default, _policies...>::type>::type type;
+  };
+
+  /*
+    Compression policies : find(s, u, visit) returns the leader of u
+    in the storage s, without recursion. The visitor is called on each
+    vertex of the path from u that is not a leader, in the order of
+    the path, before any change : it is all what is needed to restore
+    the path, since the parent of each visited vertex was the next
+    visited vertex (the last one being below the leader).
+  */
+
+  //path compression : all the vertices of the path are linked to the
+  //leader, in two passes
+  struct t_full_compression{
+    typedef t_compression_policy_tag policy_category;
+
+    template <class _storage, class _visitor>
+    static typename _storage::vertex_t find(_storage& s, typename _storage::vertex_t u, _visitor visit)
+    {
+      typename _storage::vertex_t root = u;
+      while(s.parent(root) != root)
+	{
+	  visit(root);
+	  root = s.parent(root);
+	}
+      while(u != root)
+	{
+	  typename _storage::vertex_t next = s.parent(u);
+	  if(next != root)
+	    s.set_parent(u, root);
+	  u = next;
+	}
+      return root;
+    }
+  };
+
+  //path halving : every other vertex of the path is linked to its
+  //grand parent, in one pass
+  struct t_path_halving{
+    typedef t_compression_policy_tag policy_category;
+
+    template <class _storage, class _visitor>
+    static typename _storage::vertex_t find(_storage& s, typename _storage::vertex_t u, _visitor visit)
+    {
+      while(true)
+	{
+	  typename _storage::vertex_t p = s.parent(u);
+	  if(p == u)
+	    return u;
+	  visit(u);
+	  typename _storage::vertex_t g = s.parent(p);
+	  if(g == p)
+	    return p;
+	  visit(p);
+	  s.set_parent(u, g);
+	  u = g;
+	}
+    }
+  };
+
+  //path splitting : every vertex of the path is linked to its grand
+  //parent, in one pass
+  struct t_path_splitting{
+    typedef t_compression_policy_tag policy_category;
+
+    template <class _storage, class _visitor>
+    static typename _storage::vertex_t find(_storage& s, typename _storage::vertex_t u, _visitor visit)
+    {
+      while(true)
+	{
+	  typename _storage::vertex_t p = s.parent(u);
+	  if(p == u)
+	    return u;
+	  visit(u);
+	  typename _storage::vertex_t g = s.parent(p);
+	  if(g == p)
+	    return p;
+	  s.set_parent(u, g);
+	  u = p;
+	}
+    }
+  };
+
+  //no compression : the structure is only changed by unions, the
+  //depth being bounded by the linking policy
+  struct t_no_compression{
+    typedef t_compression_policy_tag policy_category;
+
+    template <class _storage, class _visitor>
+    static typename _storage::vertex_t find(_storage& s, typename _storage::vertex_t u, _visitor)
+    {
+      while(s.parent(u) != u)
+	u = s.parent(u);
+      return u;
+    }
+  };
+
+  /*
+    Linking policies : link(s, u, v, changed) chooses which of the two
+    distinct leaders u and v becomes the leader of the union, and
+    updates its weight; changed tells if the weight of the new leader
+    was modified. unlink(s, leader, child, changed) restores the
+    weight of the leader when rewinding. The caller changes the
+    parents.
+  */
+
+  //union by rank : the leader is the one with the highest rank, u on
+  //equality, whose rank is then increased
+  struct t_link_by_rank{
+    typedef t_linking_policy_tag policy_category;
+
+    static const unsigned FILE_ID = 0;//identifier in the saved files
+
+    //the rank is at most log2(n)
+    template <class _vertex>
+    struct weight{
+      typedef unsigned char type;
+    };
+
+    static const bool USES_WEIGHT = true;
+
+    template <class _weight>
+    static _weight initial_weight(void)
+    {
+      return 0;
+    }
+
+    template <class _storage>
+    static typename _storage::vertex_t link(_storage& s, typename _storage::vertex_t u, typename _storage::vertex_t v, bool& changed)
+    {
+      changed = false;
+      if(s.weight(u) < s.weight(v))
+	return v;
+      if(!(s.weight(v) < s.weight(u)))
+	{
+	  s.set_weight(u, s.weight(u) + 1);
+	  changed = true;
+	}
+      return u;
+    }
+
+    template <class _storage>
+    static void unlink(_storage& s, typename _storage::vertex_t leader, typename _storage::vertex_t, bool changed)
+    {
+      if(changed)
+	s.set_weight(leader, s.weight(leader) - 1);
+    }
+  };
+
+  //union by size : the leader is the one of the largest set, u on
+  //equality
+  struct t_link_by_size{
+    typedef t_linking_policy_tag policy_category;
+
+    static const unsigned FILE_ID = 1;//identifier in the saved files
+
+    template <class _vertex>
+    struct weight{
+      typedef _vertex type;
+    };
+
+    static const bool USES_WEIGHT = true;
+
+    template <class _weight>
+    static _weight initial_weight(void)
+    {
+      return 1;
+    }
+
+    template <class _storage>
+    static typename _storage::vertex_t link(_storage& s, typename _storage::vertex_t u, typename _storage::vertex_t v, bool& changed)
+    {
+      changed = true;
+      if(s.weight(u) < s.weight(v))
+	std::swap(u, v);
+      s.set_weight(u, s.weight(u) + s.weight(v));
+      return u;
+    }
+
+    template <class _storage>
+    static void unlink(_storage& s, typename _storage::vertex_t leader, typename _storage::vertex_t child, bool)
+    {
+      s.set_weight(leader, s.weight(leader) - s.weight(child));
+    }
+  };
+
+  //randomized linking by index : the leader is the one with the
+  //highest priority, a pseudo-random permutation of the indices; it
+  //needs no weight
+  struct t_link_by_random_index{
+    typedef t_linking_policy_tag policy_category;
+
+    static const unsigned FILE_ID = 2;//identifier in the saved files
+
+    template <class _vertex>
+    struct weight{
+      typedef unsigned char type;
+    };
+
+    static const bool USES_WEIGHT = false;
+
+    template <class _weight>
+    static _weight initial_weight(void)
+    {
+      return _weight();
+    }
+
+    //bijective mixing of the index (splitmix64 finalizer)
+    static std::uint64_t priority(std::uint64_t u)
+    {
+      u = (u ^ (u >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      u = (u ^ (u >> 27)) * 0x94d049bb133111ebULL;
+      return u ^ (u >> 31);
+    }
+
+    template <class _storage>
+    static typename _storage::vertex_t link(_storage&, typename _storage::vertex_t u, typename _storage::vertex_t v, bool& changed)
+    {
+      changed = false;
+      return priority(u) < priority(v) ? v : u;
+    }
+
+    template <class _storage>
+    static void unlink(_storage&, typename _storage::vertex_t, typename _storage::vertex_t, bool)
+    {
+    }
+  };
+
+  /*
+    Vertex index policy : the unsigned integer type of the vertices,
+    std::size_t by default. A narrower type divides the memory of the
+    structure, e.g. t_vertex_index<std::uint32_t> for less than 2^32
+    vertices.
+  */
+
+  template <class _vertex>
+  struct t_vertex_index{
+    typedef t_vertex_index_policy_tag policy_category;
+    typedef _vertex                   type;
+  };
+
+  /*
+    Weight storage policies : where the weights (rank or size) of the
+    leaders are stored (see storage.hpp).
+  */
+
+  //one array of parents and one array of weights, a byte per vertex
+  //for the ranks
+  struct t_weights_in_array{
+    typedef t_weight_storage_policy_tag policy_category;
+
+    template <class _vertex, class _weight, bool WITH_WEIGHTS, class _allocator = std::allocator<_vertex> >
+    struct storage{
+      typedef t_union_find_storage<_vertex, _weight, WITH_WEIGHTS, _allocator> type;
+      typedef t_union_find_storage_view<_vertex, _weight, WITH_WEIGHTS> view_type;
+    };
+  };
+
+  //one array of parents, the slot of a leader storing its weight with
+  //the highest bit set, at the cost of one bit of the vertex index
+  struct t_weights_in_parents{
+    typedef t_weight_storage_policy_tag policy_category;
+
+    template <class _vertex, class _weight, bool WITH_WEIGHTS, class _allocator = std::allocator<_vertex> >
+    struct storage{
+      typedef t_union_find_packed_storage<_vertex, _weight, _allocator> type;
+      typedef t_union_find_packed_storage_view<_vertex, _weight> view_type;
+    };
+  };
+
+  /*
+    Member policies : per-vertex data kept to enumerate the members of
+    a set. The members of a set form a circular list through the next
+    array, two lists being spliced in O(1) by swapping the next
+    vertices of the two leaders, which is its own inverse when
+    rewinding. The size of each set is kept at its leader.
+  */
+
+  //no member list : enumerating a set scans all the vertices
+  struct t_no_member_lists{
+    typedef t_member_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    struct data{
+      static const bool ENABLED = false;
+      void clear(void){}
+      void reserve(std::size_t){}
+      void push_back(_vertex){}
+      void grow(std::size_t){}
+      void pop_back(void){}
+      void make_singleton(_vertex){}
+      void link(_vertex, _vertex){}
+      void unlink(_vertex, _vertex){}
+      _vertex next(_vertex u)const{return u;}
+      std::size_t size(_vertex)const{return 1;}
+      void resize(std::size_t){}
+      _vertex* next_data(void){return nullptr;}
+      const _vertex* next_data(void)const{return nullptr;}
+      _vertex* sizes_data(void){return nullptr;}
+      const _vertex* sizes_data(void)const{return nullptr;}
+    };
+  };
+
+  //circular member lists : enumerating a set costs O(|set|) and its
+  //size O(1), for two extra vertex indices per vertex
+  struct t_member_lists{
+    typedef t_member_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    class data{
+    public:
+      static const bool ENABLED = true;
+    private:
+      typename t_allocator_vector<_vertex, _allocator>::type m_next;//next member in the circular list
+      typename t_allocator_vector<_vertex, _allocator>::type m_sizes;//size of the set, for a leader
+    public:
+      void clear(void){this->m_next.clear(); this->m_sizes.clear();}
+      void reserve(std::size_t n){this->m_next.reserve(n); this->m_sizes.reserve(n);}
+      void push_back(_vertex u){this->m_next.push_back(u); this->m_sizes.push_back(1);}
+      //adds n singletons
+      void grow(std::size_t n)
+      {
+	std::size_t size = this->m_next.size();
+	this->m_next.resize(size + n);
+	std::iota(this->m_next.begin() + size, this->m_next.end(), _vertex(size));
+	this->m_sizes.resize(size + n, 1);
+      }
+      void pop_back(void){this->m_next.pop_back(); this->m_sizes.pop_back();}
+      void make_singleton(_vertex u){this->m_next[u] = u; this->m_sizes[u] = 1;}
+      //the leader of the set of child becomes leader
+      void link(_vertex leader, _vertex child)
+      {
+	std::swap(this->m_next[leader], this->m_next[child]);
+	this->m_sizes[leader] += this->m_sizes[child];
+      }
+      //undoes the link of child below leader
+      void unlink(_vertex leader, _vertex child)
+      {
+	std::swap(this->m_next[leader], this->m_next[child]);
+	this->m_sizes[leader] -= this->m_sizes[child];
+      }
+      _vertex next(_vertex u)const{return this->m_next[u];}
+      std::size_t size(_vertex leader)const{return this->m_sizes[leader];}
+      //raw arrays, for serialization
+      void resize(std::size_t n){this->m_next.resize(n); this->m_sizes.resize(n);}
+      _vertex* next_data(void){return this->m_next.data();}
+      const _vertex* next_data(void)const{return this->m_next.data();}
+      _vertex* sizes_data(void){return this->m_sizes.data();}
+      const _vertex* sizes_data(void)const{return this->m_sizes.data();}
+    };
+  };
+
+  /*
+    Reset policies : how reset() turns all the vertices back into
+    singletons, storage<_storage>::type wrapping the storage if needed.
+  */
+
+  //every parent and weight is rewritten (O(n))
+  struct t_eager_reset{
+    typedef t_reset_policy_tag policy_category;
+
+    template <class _storage>
+    struct storage{
+      typedef _storage type;
+    };
+  };
+
+  //a generation stamp per vertex is checked on each access, so that
+  //the parents and weights are reset in O(1) and a vertex is only
+  //rewritten on its first change after a reset, for 4 more bytes per
+  //vertex; the other policies still reset their arrays in O(n)
+  struct t_lazy_reset{
+    typedef t_reset_policy_tag policy_category;
+
+    template <class _storage>
+    struct storage{
+      typedef t_union_find_lazy_storage<_storage> type;
+    };
+  };
+
+  /*
+    Aggregate policies : a value per vertex, combined at the leader by
+    union_sets so that the value of a set is read in O(1). The combine
+    function must be associative, and commutative since the order of
+    the operands depends on the linking. The previous values of the
+    leaders are kept in a stack to be restored by the Rewind feature.
+  */
+
+  //no aggregate
+  struct t_no_aggregate{
+    typedef t_aggregate_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    struct data{
+      struct value_type{};
+      static const bool ENABLED = false;
+      void clear(void){}
+      void reserve(std::size_t){}
+      void push_back(const value_type&){}
+      void grow(std::size_t){}
+      void pop_back(void){}
+      void reset(void){}
+      void link(_vertex, _vertex, bool){}
+      void unlink(_vertex){}
+      void clear_log(void){}
+    };
+  };
+
+  //values of type _value combined by the functor _combine, e.g.
+  //t_aggregate<long, std::plus<long> > for the sum of the values of
+  //each set; it costs two values per vertex, the initial one being
+  //kept for reset()
+  template <class _value, class _combine>
+  struct t_aggregate{
+    typedef t_aggregate_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    class data{
+    public:
+      typedef _value value_type;
+      static const bool ENABLED = true;
+    private:
+      typename t_allocator_vector<_value, _allocator>::type m_initial;//initial value of each vertex
+      typename t_allocator_vector<_value, _allocator>::type m_values;//value of the set, for a leader
+      typename t_allocator_vector<_value, _allocator>::type m_log;//previous values of the leaders
+      _combine                                              m_combine;
+    public:
+      void clear(void){this->m_initial.clear(); this->m_values.clear(); this->m_log.clear();}
+      void reserve(std::size_t n){this->m_initial.reserve(n); this->m_values.reserve(n);}
+      void push_back(const _value& x){this->m_initial.push_back(x); this->m_values.push_back(x);}
+      //adds n vertices with the default value
+      void grow(std::size_t n)
+      {
+	this->m_initial.resize(this->m_initial.size() + n);
+	this->m_values.resize(this->m_values.size() + n);
+      }
+      void pop_back(void){this->m_initial.pop_back(); this->m_values.pop_back();}
+      void reset(void){this->m_values = this->m_initial; this->m_log.clear();}
+      //the set of child is merged in the set of leader, the previous
+      //value of leader being recorded for the rewind
+      void link(_vertex leader, _vertex child, bool record)
+      {
+	if(record)
+	  this->m_log.push_back(this->m_values[leader]);
+	this->m_values[leader] = this->m_combine(this->m_values[leader], this->m_values[child]);
+      }
+      //undoes the last recorded link of leader
+      void unlink(_vertex leader)
+      {
+	this->m_values[leader] = this->m_log.back();
+	this->m_log.pop_back();
+      }
+      void clear_log(void){this->m_log.clear();}
+      const _value& value(_vertex leader)const{return this->m_values[leader];}
+    };
+  };
+
+  /*
+    Removal policies : the state of each vertex, for remove_vertex and
+    remove_set. A removed vertex is a tombstone left in the tree of its
+    set, since other vertices may still go through it, until its whole
+    set is removed or compact() relinks the vertices alive. The indices
+    of the vertices of the removed sets are kept in a free list and
+    recycled by make_set. The number of vertices alive in a set is kept
+    at its leader.
+  */
+
+  //no removal
+  struct t_no_removal{
+    typedef t_removal_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    struct data{
+      static const bool ENABLED = false;
+      void clear(void){}
+      void reserve(std::size_t){}
+      void push_back(void){}
+      void grow(std::size_t){}
+      void reset(void){}
+      void link(_vertex, _vertex){}
+      bool removed(_vertex)const{return false;}
+      bool released(_vertex)const{return false;}
+      std::size_t alive(_vertex)const{return 1;}
+      std::size_t number_of_free(void)const{return 0;}
+      _vertex recycle(void){return _vertex();}
+    };
+  };
+
+  //tombstones and free list : one byte and one vertex index per
+  //vertex, plus the free list
+  struct t_free_list{
+    typedef t_removal_policy_tag policy_category;
+
+    template <class _vertex, class _allocator = std::allocator<_vertex> >
+    class data{
+    public:
+      static const bool ENABLED = true;
+    private:
+      enum state_t : unsigned char{
+	ALIVE,
+	REMOVED,//tombstone in a set alive
+	FREE//in the free list
+      };
+      typename t_allocator_vector<unsigned char, _allocator>::type m_states;
+      typename t_allocator_vector<_vertex, _allocator>::type       m_alive;//number of vertices alive in the set, for a leader
+      typename t_allocator_vector<_vertex, _allocator>::type       m_free;
+    public:
+      void clear(void){this->m_states.clear(); this->m_alive.clear(); this->m_free.clear();}
+      void reserve(std::size_t n){this->m_states.reserve(n); this->m_alive.reserve(n);}
+      void push_back(void){this->m_states.push_back(ALIVE); this->m_alive.push_back(1);}
+      void grow(std::size_t n)
+      {
+	this->m_states.resize(this->m_states.size() + n, ALIVE);
+	this->m_alive.resize(this->m_alive.size() + n, 1);
+      }
+      //all the vertices are alive again
+      void reset(void)
+      {
+	std::fill(this->m_states.begin(), this->m_states.end(), ALIVE);
+	std::fill(this->m_alive.begin(), this->m_alive.end(), 1);
+	this->m_free.clear();
+      }
+      void link(_vertex leader, _vertex child){this->m_alive[leader] += this->m_alive[child];}
+      bool removed(_vertex u)const{return this->m_states[u] != ALIVE;}
+      bool released(_vertex u)const{return this->m_states[u] == FREE;}
+      std::size_t alive(_vertex leader)const{return this->m_alive[leader];}
+      //u becomes a tombstone, returns the number of vertices alive left
+      //in its set
+      std::size_t remove(_vertex u, _vertex leader)
+      {
+	this->m_states[u] = REMOVED;
+	return --this->m_alive[leader];
+      }
+      //u goes to the free list, its set being removed
+      void release(_vertex u){this->m_states[u] = FREE; this->m_free.push_back(u);}
+      std::size_t number_of_free(void)const{return this->m_free.size();}
+      //returns a vertex of the free list, alive again
+      _vertex recycle(void)
+      {
+	_vertex u = this->m_free.back();
+	this->m_free.pop_back();
+	this->m_states[u] = ALIVE;
+	this->m_alive[u] = 1;
+	return u;
+      }
+    };
+  };
+
+  /*
+    Statistics policies : counters of the operations, read with
+    t_union_find::stats(). The storage is wrapped to count the parents
+    written by the compression, and without statistics every call is
+    empty, so that nothing is left in the compiled code.
+  */
+
+  //no statistics
+  struct t_no_stats{
+    typedef t_stats_policy_tag policy_category;
+
+    template <class _storage>
+    struct storage{
+      typedef _storage type;
+    };
+
+    template <class _vertex>
+    struct data{
+      static const bool ENABLED = false;
+      template <class _storage>
+      static std::size_t parent_writes(const _storage&){return 0;}
+      void clear(void){}
+      void make_sets(std::size_t){}
+      void find(std::size_t, std::size_t){}
+      void union_sets(bool){}
+      void rewind(void){}
+      void log(std::size_t){}
+    };
+  };
+
+  //counters and histograms of the paths, for a few machine words per
+  //structure
+  struct t_stats{
+    typedef t_stats_policy_tag policy_category;
+
+    template <class _storage>
+    struct storage{
+      typedef t_union_find_counting_storage<_storage> type;
+    };
+
+    template <class _vertex>
+    class data{
+    public:
+      static const bool ENABLED = true;
+    private:
+      t_union_find_stats m_stats;
+    public:
+      template <class _storage>
+      static std::size_t parent_writes(const _storage& s){return s.parent_writes();}
+      void clear(void){this->m_stats = t_union_find_stats();}
+      void make_sets(std::size_t n){this->m_stats.nb_make_sets += n;}
+      //a find walking length vertices below the leader, and rewriting
+      //writes parents
+      void find(std::size_t length, std::size_t writes)
+      {
+	this->m_stats.nb_finds++;
+	this->m_stats.nb_path_vertices += length;
+	this->m_stats.nb_compression_writes += writes;
+	this->m_stats.path_lengths[t_union_find_stats::bucket(length)]++;
+      }
+      void union_sets(bool merged)
+      {
+	this->m_stats.nb_unions++;
+	if(!merged)
+	  this->m_stats.nb_failed_unions++;
+      }
+      void rewind(void){this->m_stats.nb_rewinds++;}
+      //the log has now words words
+      void log(std::size_t words){this->m_stats.peak_log_words = std::max(this->m_stats.peak_log_words, words);}
+      const t_union_find_stats& stats(void)const{return this->m_stats;}
+    };
+  };
+
+  /*
+    Allocator policies : the allocator of all the arrays of the
+    structure (parents, weights, stamps, member lists, aggregates,
+    states and log), rebound to the type of each array. With
+    t_huge_pages the large arrays are backed by huge pages, which
+    cuts the TLB misses of the finds on millions of vertices (see
+    allocator.hpp); t_union_find::reserve() allocates the arrays once
+    for the expected number of vertices, so that they are not
+    reallocated and copied while growing.
+  */
+
+  //the allocator _allocator, of any value type
+  template <class _allocator>
+  struct t_allocator{
+    typedef t_allocator_policy_tag policy_category;
+    typedef _allocator             type;
+  };
+
+  //transparent huge pages when the kernel has some, the default
+  //allocator on other systems
+  typedef t_allocator<t_huge_page_allocator<char> > t_huge_pages;
+
+  //reserved huge pages when some are left, transparent huge pages
+  //otherwise
+  typedef t_allocator<t_huge_page_allocator<char, true> > t_reserved_huge_pages;
+
+  /*
+    Log policies : where the operations are recorded for the Rewind
+    feature (see operation_log.hpp and spilling_log.hpp).
+  */
+
+  //the whole log in memory
+  struct t_memory_log{
+    typedef t_log_policy_tag policy_category;
+
+    template <class _word, class _allocator>
+    struct log{
+      typedef t_operation_log<_word, _allocator> type;
+    };
+  };
+
+  //at most HOT_WORDS words of the log in memory, the older ones being
+  //spilled to a temporary file and read back by the rewind, for long
+  //histories; the structure can then be moved but not copied
+  template <std::size_t HOT_WORDS = (std::size_t(1) << 24)>
+  struct t_spilling_log{
+    typedef t_log_policy_tag policy_category;
+
+    template <class _word, class _allocator>
+    struct log{
+      typedef t_spilling_operation_log<_word, HOT_WORDS, _allocator> type;
+    };
+  };
+
+}//end namespace utils
+
+#endif
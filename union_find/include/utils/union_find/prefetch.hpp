@@ -0,0 +1,34 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_PREFETCH_HPP_
+#define _UTILS_UNION_FIND_PREFETCH_HPP_
+
+namespace utils{
+
+  //hints the processor to load the cache line of the address for a
+  //read, does nothing on the compilers without the builtin
+  inline void prefetch(const void* address)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+  }
+
+}//end namespace utils
+
+#endif
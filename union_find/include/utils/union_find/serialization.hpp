@@ -0,0 +1,189 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_SERIALIZATION_HPP_
+#define _UTILS_UNION_FIND_SERIALIZATION_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace utils{
+  /*
+    Binary file format of a Union-Find structure, written by
+    t_union_find::save and read by t_union_find::load or mapped by
+    t_mapped_union_find. The file is made of a header of 64 bytes
+    followed by sections, each one starting on a multiple of 64 bytes
+    so that they can be mapped in place :
+
+    - the parents (or the slots with t_weights_in_parents),
+    - the weights, if stored in a separate array,
+    - the next vertices and the sizes of the member lists, if any,
+    - the words of the rewind log, if saved.
+
+    The integers are stored in the native byte order. The header
+    records the layout of the structure, and a file can only be read
+    back by a structure with the same layout. A file is only accepted
+    if it holds all the sections of its header, and if its parents
+    (and member lists) stay in the structure, so that a corrupt file
+    is refused instead of being read out of bounds.
+  */
+
+  struct t_union_find_file_header{
+    char          magic[8];//"UTILSUF"
+    std::uint32_t version;//version of the format
+    std::uint32_t vertex_bytes;//size of a vertex index
+    std::uint32_t weight_bytes;//size of a weight in its own array, 0 if none
+    std::uint32_t linking;//FILE_ID of the linking policy
+    std::uint32_t flags;//WEIGHTS_IN_PARENTS | MEMBER_LISTS | REWIND_LOG
+    std::uint32_t reserved;
+    std::uint64_t size;//number of vertices
+    std::uint64_t nb_cc;//number of independent sets
+    std::uint64_t log_words;//number of words in the log
+    std::uint64_t reserved2;
+
+    static const std::uint32_t VERSION            = 1;
+    static const std::uint32_t WEIGHTS_IN_PARENTS = 1;
+    static const std::uint32_t MEMBER_LISTS       = 2;
+    static const std::uint32_t REWIND_LOG         = 4;
+    static const std::uint64_t ALIGNMENT          = 64;
+
+    t_union_find_file_header(void)
+    {
+      std::memset(this, 0, sizeof(t_union_find_file_header));
+      std::memcpy(this->magic, "UTILSUF", 8);
+      this->version = VERSION;
+    }
+
+    //returns true iff the header was written for the same layout
+    bool same_layout(const t_union_find_file_header& h)const
+    {
+      return std::memcmp(this->magic, h.magic, 8) == 0
+	&& this->version == h.version
+	&& this->vertex_bytes == h.vertex_bytes
+	&& this->weight_bytes == h.weight_bytes
+	&& this->linking == h.linking
+	&& (this->flags & ~REWIND_LOG) == (h.flags & ~REWIND_LOG);
+    }
+
+    static std::uint64_t align(std::uint64_t offset)
+    {
+      return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    //offsets of the sections in the file
+    std::uint64_t parents_offset(void)const{return align(sizeof(t_union_find_file_header));}
+    std::uint64_t weights_offset(void)const{return align(this->parents_offset() + this->size * this->vertex_bytes);}
+    std::uint64_t members_offset(void)const{return align(this->weights_offset() + this->size * this->weight_bytes);}
+    std::uint64_t log_offset(void)const
+    {
+      std::uint64_t members_bytes = (this->flags & MEMBER_LISTS) ? 2 * this->size * this->vertex_bytes : 0;
+      return align(this->members_offset() + members_bytes);
+    }
+    std::uint64_t file_size(void)const{return this->log_offset() + this->log_words * this->vertex_bytes;}
+
+    //returns true iff the sections end before length bytes, the
+    //counts being bounded so that the offsets cannot wrap
+    bool fits(std::uint64_t length)const
+    {
+      const std::uint64_t max_count = std::uint64_t(1) << 56;
+      return this->vertex_bytes <= 8 && this->weight_bytes <= 8
+	&& this->size < max_count && this->log_words < max_count
+	&& this->nb_cc <= this->size
+	&& this->file_size() <= length;
+    }
+  };
+
+  static_assert(sizeof(t_union_find_file_header) == 64, "the header of the union-find files takes 64 bytes");
+
+  //writes the bytes at the offset of the file, padding with zeros
+  //from the current position
+  inline bool write_union_find_section(std::FILE* file, std::uint64_t offset, const void* data, std::size_t bytes)
+  {
+    static const char zeros[t_union_find_file_header::ALIGNMENT] = {0};
+    long position = std::ftell(file);
+    if(position < 0 || std::uint64_t(position) > offset)
+      return false;
+    if(std::fwrite(zeros, 1, std::size_t(offset - position), file) != std::size_t(offset - position))
+      return false;
+    return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+  }
+
+  //returns true iff every parent(u) is one of the n vertices, every
+  //path of parents ends at a root, and there are nb_cc roots, so that
+  //the finds stay in the structure and end (O(n))
+  template <class _parent>
+  bool valid_union_find_forest(std::size_t n, std::size_t nb_cc, _parent parent)
+  {
+    //0 unvisited, 1 on the path being walked, 2 leading to a root
+    std::vector<unsigned char> states(n, 0);
+    std::size_t nb_roots = 0;
+    for(std::size_t u = 0; u < n; u++)
+      {
+	std::size_t v = u;
+	while(states[v] == 0)
+	  {
+	    std::size_t p = std::size_t(parent(v));
+	    if(p >= n)
+	      return false;
+	    states[v] = 1;
+	    if(p == v)
+	      {
+		states[v] = 2;
+		nb_roots++;
+	      }
+	    else
+	      v = p;
+	  }
+	//the walk came back on its own path
+	if(states[v] == 1)
+	  return false;
+	for(v = u; states[v] == 1; v = std::size_t(parent(v)))
+	  states[v] = 2;
+      }
+    return nb_roots == nb_cc;
+  }
+
+  //returns true iff the next members are a permutation of the n
+  //vertices, so that each walk of a member list comes back to its
+  //start, and every size is at most n (O(n))
+  template <class _vertex>
+  bool valid_union_find_members(std::size_t n, const _vertex* next, const _vertex* sizes)
+  {
+    std::vector<bool> reached(n, false);
+    for(std::size_t u = 0; u < n; u++)
+      {
+	std::size_t v = std::size_t(next[u]);
+	if(v >= n || reached[v] || sizes[u] == 0 || std::size_t(sizes[u]) > n)
+	  return false;
+	reached[v] = true;
+      }
+    return true;
+  }
+
+  //reads the bytes at the offset of the file
+  inline bool read_union_find_section(std::FILE* file, std::uint64_t offset, void* data, std::size_t bytes)
+  {
+    if(bytes == 0)
+      return true;
+    if(std::fseek(file, long(offset), SEEK_SET) != 0)
+      return false;
+    return std::fread(data, 1, bytes, file) == bytes;
+  }
+
+}//end namespace utils
+
+#endif
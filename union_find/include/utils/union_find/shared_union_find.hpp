@@ -0,0 +1,253 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_SHARED_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_SHARED_UNION_FIND_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <new>
+#include <utils/union_find/concurrent_union_find.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils{
+  /*
+    A lock-free Union-Find living in a POSIX shared memory segment
+    (shm_open, POSIX only), so that several processes of the same host
+    union and find concurrently in one partition. It runs the algorithm
+    of t_atomic_union_find_view on the words of the segment : a word
+    packs the index of the parent and the rank of a vertex, so that the
+    segment does not depend on the address where each process maps it.
+
+    One process creates the segment with its number of vertices, the
+    others attach it by name; each process detaches it when it is done,
+    and the segment lasts until remove() is called and every process
+    has detached it. The segment is made of a header of 64 bytes,
+    holding the number of vertices and the number of independent sets,
+    followed by one word per vertex. An attach fails while the creator
+    has not finished to initialize the segment.
+
+    The atomic operations on the segment are only shared between the
+    processes if the atomic words are lock-free, which is checked by
+    create and attach.
+  */
+
+  class t_shared_union_find : public t_atomic_union_find_view{
+
+    //Types
+
+  private:
+
+    struct header_t{
+      char                       magic[8];//"UTILSSH"
+      std::atomic<std::uint32_t> ready;//1 once the segment is initialized
+      std::uint32_t              version;//version of the layout
+      std::uint64_t              size;//number of vertices
+      std::atomic<std::uint64_t> nb_cc;//number of independent sets
+    };
+
+    static const std::uint32_t VERSION      = 1;
+    static const std::size_t   WORDS_OFFSET = 64;
+
+    static_assert(sizeof(header_t) <= WORDS_OFFSET, "the header of the shared segment takes 64 bytes");
+
+    //Attributes
+
+  private:
+
+    void*       m_address;
+    std::size_t m_length;
+
+    //Constructors
+
+  public:
+
+    t_shared_union_find(void);
+
+    ~t_shared_union_find(void);
+
+    t_shared_union_find(const t_shared_union_find&) = delete;
+
+    t_shared_union_find& operator=(const t_shared_union_find&) = delete;
+
+    //Internal
+
+  private:
+
+    //returns true iff the atomic words can be shared between processes
+    static bool is_lock_free(void);
+
+    //maps length bytes of the segment fd, returns false on failure
+    bool map(int fd, std::size_t length);
+
+    //Segment
+
+  public:
+
+    //creates the segment name (e.g. "/components") with n vertices in
+    //their own set and attaches it, returns false if it exists or on
+    //failure (O(n))
+    bool create(const char* name, std::size_t n);
+
+    //attaches the segment name created by another process, returns
+    //false on failure or if it is not initialized yet (O(1))
+    bool attach(const char* name);
+
+    //detaches the segment, that stays for the other processes (O(1))
+    void detach(void);
+
+    //returns true iff a segment is attached (O(1))
+    bool is_attached(void)const;
+
+    //removes the name of the segment, the memory being released once
+    //every process detached it (O(1))
+    static bool remove(const char* name);
+
+  };//end class t_shared_union_find
+
+  //Implementation
+
+  inline t_shared_union_find::t_shared_union_find(void)
+    : t_atomic_union_find_view(),
+      m_address(nullptr),
+      m_length(0)
+  {
+  }
+
+  inline t_shared_union_find::~t_shared_union_find(void)
+  {
+    this->detach();
+  }
+
+  inline bool t_shared_union_find::is_lock_free(void)
+  {
+    std::atomic<word_t> word(0);
+    std::atomic<std::uint64_t> counter(0);
+    return word.is_lock_free() && counter.is_lock_free();
+  }
+
+  inline bool t_shared_union_find::map(int fd, std::size_t length)
+  {
+    void* address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(address == MAP_FAILED)
+      return false;
+    this->m_address = address;
+    this->m_length = length;
+    return true;
+  }
+
+  inline bool t_shared_union_find::create(const char* name, std::size_t n)
+  {
+    this->detach();
+
+    if(!is_lock_free() || n > PARENT_MASK)
+      return false;
+
+    int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0)
+      return false;
+    std::size_t length = WORDS_OFFSET + n * sizeof(word_t);
+    bool ok = ::ftruncate(fd, off_t(length)) == 0 && this->map(fd, length);
+    ::close(fd);
+    if(!ok)
+      {
+	::shm_unlink(name);
+	return false;
+      }
+
+    //the segment is filled with zeros by ftruncate
+    char* base = static_cast<char*>(this->m_address);
+    header_t* header = reinterpret_cast<header_t*>(base);
+    std::memcpy(header->magic, "UTILSSH", 8);
+    header->version = VERSION;
+    header->size = n;
+    new(&header->nb_cc) std::atomic<std::uint64_t>(n);
+    std::atomic<word_t>* words = reinterpret_cast<std::atomic<word_t>*>(base + WORDS_OFFSET);
+    for(vertex_t u = 0; u < n; u++)
+      new(&words[u]) std::atomic<word_t>(make_word(u, 0));
+
+    this->m_words = words;
+    this->m_size = n;
+    this->m_nb_cc = &header->nb_cc;
+    new(&header->ready) std::atomic<std::uint32_t>(0);
+    header->ready.store(1, std::memory_order_release);
+    return true;
+  }
+
+  inline bool t_shared_union_find::attach(const char* name)
+  {
+    this->detach();
+
+    if(!is_lock_free())
+      return false;
+
+    int fd = ::shm_open(name, O_RDWR, 0);
+    if(fd < 0)
+      return false;
+    struct stat status;
+    bool ok = ::fstat(fd, &status) == 0
+      && std::uint64_t(status.st_size) >= WORDS_OFFSET
+      && this->map(fd, std::size_t(status.st_size));
+    ::close(fd);
+    if(!ok)
+      return false;
+
+    char* base = static_cast<char*>(this->m_address);
+    header_t* header = reinterpret_cast<header_t*>(base);
+    ok = header->ready.load(std::memory_order_acquire) == 1
+      && std::memcmp(header->magic, "UTILSSH", 8) == 0
+      && header->version == VERSION
+      && header->size <= (this->m_length - WORDS_OFFSET) / sizeof(word_t);
+    if(!ok)
+      {
+	this->detach();
+	return false;
+      }
+
+    this->m_words = reinterpret_cast<std::atomic<word_t>*>(base + WORDS_OFFSET);
+    this->m_size = std::size_t(header->size);
+    this->m_nb_cc = &header->nb_cc;
+    return true;
+  }
+
+  inline void t_shared_union_find::detach(void)
+  {
+    if(this->m_address != nullptr)
+      ::munmap(this->m_address, this->m_length);
+    this->m_address = nullptr;
+    this->m_length = 0;
+    this->m_words = nullptr;
+    this->m_size = 0;
+    this->m_nb_cc = nullptr;
+  }
+
+  inline bool t_shared_union_find::is_attached(void)const
+  {
+    return this->m_address != nullptr;
+  }
+
+  inline bool t_shared_union_find::remove(const char* name)
+  {
+    return ::shm_unlink(name) == 0;
+  }
+
+}//end namespace utils
+
+#endif
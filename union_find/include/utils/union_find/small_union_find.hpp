@@ -0,0 +1,440 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_SMALL_UNION_FIND_HPP_
+#define _UTILS_UNION_FIND_SMALL_UNION_FIND_HPP_
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+//the operations of t_small_union_find are constexpr from C++14, the
+//rules of C++11 forbidding loops and assignments in constexpr
+//functions
+#if __cplusplus >= 201402L
+#define UTILS_UNION_FIND_CONSTEXPR constexpr
+#else
+#define UTILS_UNION_FIND_CONSTEXPR
+#endif
+
+namespace utils{
+
+  //smallest unsigned type able to index N vertices
+  template <std::size_t N>
+  struct t_small_index{
+    typedef typename std::conditional<(N <= 0x100), std::uint8_t,
+				      typename std::conditional<(N <= 0x10000), std::uint16_t,
+								std::uint32_t>::type>::type type;
+  };
+
+  /*
+    A Union-Find structure of at most N vertices, for the many tiny
+    structures where the allocations of t_union_find (two vectors and
+    the log) cost more than the unions : the parents and ranks are
+    arrays inside the object, indexed by the smallest unsigned type
+    holding N, so that the structure lives on the stack and is never
+    allocated. The finds halve the paths and the unions link by rank.
+
+    The interface is the one of t_union_find<false>, without the
+    checkpoints, the serialization and the snapshots, and the batch
+    operations run on the calling thread. For N <= 64, each leader
+    keeps the bitmask of its set, so that independent_set is
+    O(|set|) and set_size is O(1).
+
+    Only when compiled as C++14 or later (UTILS_UNION_FIND_CONSTEXPR),
+    all the operations but the ones taking an iterator are
+    constexpr, so that a structure can be built and queried in a
+    constant expression. As C++11, like the examples and the
+    benchmarks, it is a runtime structure only.
+  */
+
+  template <std::size_t N>
+  class t_small_union_find{
+
+    static_assert(N > 0 && N <= 0xffffffffu, "t_small_union_find holds 1 to 2^32 - 1 vertices");
+
+    //Types
+
+  public:
+
+    typedef typename t_small_index<N>::type vertex_t;
+
+    static const std::size_t CAPACITY = N;
+    static const bool        WITH_MASKS = N <= 64;//a bitmask per set
+
+  private:
+
+    typedef std::uint64_t                       mask_t;
+    typedef typename t_small_index<N + 1>::type count_t;//0 to N
+
+    //Attributes
+
+  private:
+
+    vertex_t      m_parents[N];
+    std::uint8_t  m_ranks[N];
+    mask_t        m_masks[WITH_MASKS ? N : 1];//vertices of each leader
+    count_t       m_size;
+    count_t       m_nb_cc;
+
+    //Constructors
+
+  public:
+
+    UTILS_UNION_FIND_CONSTEXPR t_small_union_find(void);
+
+    //Internal
+
+  private:
+
+    //Check that u is a vertex of this structure.
+    UTILS_UNION_FIND_CONSTEXPR bool is_valid(vertex_t u)const;
+
+    //Number of bits set in x.
+    static UTILS_UNION_FIND_CONSTEXPR std::size_t count_bits(mask_t x);
+
+    //Index of the lowest bit set in x, that is not 0.
+    static UTILS_UNION_FIND_CONSTEXPR vertex_t lowest_bit(mask_t x);
+
+    //Bitmask of the set of the leader u, for N <= 64.
+    UTILS_UNION_FIND_CONSTEXPR mask_t mask(vertex_t u)const;
+
+    //Base operations
+
+  public:
+
+    //removes all vertices from the structure (O(1))
+    UTILS_UNION_FIND_CONSTEXPR void clear(void);
+
+    //does one independent set per vertex (O(n))
+    UTILS_UNION_FIND_CONSTEXPR void reset(void);
+
+    //adds a new vertex, the structure having less than N vertices
+    //(O(1))
+    UTILS_UNION_FIND_CONSTEXPR vertex_t make_set(void);
+
+    //adds n new vertices (O(n))
+    UTILS_UNION_FIND_CONSTEXPR void make_sets(std::size_t n);
+
+    //finds the leader of the set containing u with path halving
+    //(~O(1))
+    UTILS_UNION_FIND_CONSTEXPR vertex_t find_set(vertex_t u);
+
+    //unions two sets if they are disjoint (~O(1))
+    UTILS_UNION_FIND_CONSTEXPR vertex_t union_sets(vertex_t u, vertex_t v);
+
+    //Batch operations
+
+  public:
+
+    //unions the two vertices of each edge in [first, last), the edges
+    //being pairs or tuples of existing vertices; nb_threads is only
+    //there for the interface of t_union_find (~O(m))
+    template<class _random_access_iterator>
+    void union_batch(_random_access_iterator first, _random_access_iterator last, unsigned nb_threads = 0);
+
+    //unions the two vertices of each edge of the container, and
+    //returns the number of independent sets (~O(m))
+    template<class _edges>
+    std::size_t connected_components(const _edges& edges, unsigned nb_threads = 0);
+
+    //writes the leader of each vertex of [first, last) to out, without
+    //path compression (~O(m))
+    template<class _input_iterator, class _output_iterator>
+    _output_iterator find_batch(_input_iterator first, _input_iterator last, _output_iterator out)const;
+
+    //writes, for each pair of vertices of [first, last), true iff they
+    //are in the same set (~O(m))
+    template<class _input_iterator, class _output_iterator>
+    _output_iterator same_set_batch(_input_iterator first, _input_iterator last, _output_iterator out)const;
+
+    //Independent sets
+
+  public:
+
+    //returns true iff there is no vertex in the structure (O(1))
+    UTILS_UNION_FIND_CONSTEXPR bool empty(void)const;
+
+    //returns the number of vertices in the structure (O(1))
+    UTILS_UNION_FIND_CONSTEXPR std::size_t size(void)const;
+
+    //returns the number of independent sets in the structure (O(1))
+    UTILS_UNION_FIND_CONSTEXPR std::size_t number_of_independent_sets(void)const;
+
+    //fills the input container with all the leaders (O(n))
+    template<class _output_iterator>
+    _output_iterator leaders(_output_iterator out);
+
+    //fills the input container with all the vertices in the set
+    //containing u, in increasing order (O(n)), O(|set|) for N <= 64
+    template<class _output_iterator>
+    _output_iterator independent_set(vertex_t u, _output_iterator out);
+
+    //returns the number of vertices in the set containing u (O(n)),
+    //~O(1) for N <= 64
+    UTILS_UNION_FIND_CONSTEXPR std::size_t set_size(vertex_t u);
+
+    //returns the bitmask of the set containing u, the bit i being set
+    //iff the vertex i is in the set, for N <= 64 (~O(1))
+    UTILS_UNION_FIND_CONSTEXPR std::uint64_t set_mask(vertex_t u);
+
+  };//end template t_small_union_find
+
+  //Implementation
+
+  template <std::size_t N>
+  const std::size_t t_small_union_find<N>::CAPACITY;
+
+  template <std::size_t N>
+  const bool t_small_union_find<N>::WITH_MASKS;
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR t_small_union_find<N>::t_small_union_find(void)
+    : m_parents(),
+      m_ranks(),
+      m_masks(),
+      m_size(0),
+      m_nb_cc(0)
+  {
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR bool t_small_union_find<N>::is_valid(vertex_t u)const
+  {
+    return u < this->m_size;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR std::size_t t_small_union_find<N>::count_bits(mask_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return std::size_t(__builtin_popcountll(x));
+#else
+    std::size_t n = 0;
+    for(; x != 0; x &= x - 1)
+      n++;
+    return n;
+#endif
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR typename t_small_union_find<N>::vertex_t t_small_union_find<N>::lowest_bit(mask_t x)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return vertex_t(__builtin_ctzll(x));
+#else
+    vertex_t i = 0;
+    for(; (x & 1) == 0; x >>= 1)
+      i++;
+    return i;
+#endif
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR typename t_small_union_find<N>::mask_t t_small_union_find<N>::mask(vertex_t u)const
+  {
+    return this->m_masks[WITH_MASKS ? u : 0];
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR void t_small_union_find<N>::clear(void)
+  {
+    this->m_size = 0;
+    this->m_nb_cc = 0;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR void t_small_union_find<N>::reset(void)
+  {
+    for(count_t u = 0; u < this->m_size; u++)
+      {
+	this->m_parents[u] = vertex_t(u);
+	this->m_ranks[u] = 0;
+	if(WITH_MASKS)
+	  this->m_masks[u] = mask_t(1) << u;
+      }
+    this->m_nb_cc = this->m_size;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR typename t_small_union_find<N>::vertex_t t_small_union_find<N>::make_set(void)
+  {
+    assert(this->size() < N);
+
+    vertex_t u = vertex_t(this->m_size++);
+    this->m_parents[u] = u;
+    this->m_ranks[u] = 0;
+    if(WITH_MASKS)
+      this->m_masks[u] = mask_t(1) << u;
+    this->m_nb_cc++;
+    return u;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR void t_small_union_find<N>::make_sets(std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; i++)
+      this->make_set();
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR typename t_small_union_find<N>::vertex_t t_small_union_find<N>::find_set(vertex_t u)
+  {
+    assert(this->is_valid(u));
+
+    while(this->m_parents[u] != u)
+      {
+	this->m_parents[u] = this->m_parents[this->m_parents[u]];
+	u = this->m_parents[u];
+      }
+    return u;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR typename t_small_union_find<N>::vertex_t t_small_union_find<N>::union_sets(vertex_t u, vertex_t v)
+  {
+    u = this->find_set(u);
+    v = this->find_set(v);
+    if(u == v)
+      return u;
+    if(this->m_ranks[u] < this->m_ranks[v])
+      {
+	vertex_t w = u;
+	u = v;
+	v = w;
+      }
+    else if(this->m_ranks[u] == this->m_ranks[v])
+      this->m_ranks[u]++;
+    this->m_parents[v] = u;
+    if(WITH_MASKS)
+      this->m_masks[u] |= this->m_masks[v];
+    this->m_nb_cc--;
+    return u;
+  }
+
+  template <std::size_t N>
+  template<class _random_access_iterator>
+  void t_small_union_find<N>::union_batch(_random_access_iterator first, _random_access_iterator last, unsigned)
+  {
+    for(; first != last; ++first)
+      this->union_sets(vertex_t(std::get<0>(*first)), vertex_t(std::get<1>(*first)));
+  }
+
+  template <std::size_t N>
+  template<class _edges>
+  std::size_t t_small_union_find<N>::connected_components(const _edges& edges, unsigned nb_threads)
+  {
+    this->union_batch(std::begin(edges), std::end(edges), nb_threads);
+    return this->number_of_independent_sets();
+  }
+
+  template <std::size_t N>
+  template<class _input_iterator, class _output_iterator>
+  _output_iterator t_small_union_find<N>::find_batch(_input_iterator first, _input_iterator last, _output_iterator out)const
+  {
+    for(; first != last; ++first, ++out)
+      {
+	vertex_t u = vertex_t(*first);
+	assert(this->is_valid(u));
+	while(this->m_parents[u] != u)
+	  u = this->m_parents[u];
+	*out = u;
+      }
+    return out;
+  }
+
+  template <std::size_t N>
+  template<class _input_iterator, class _output_iterator>
+  _output_iterator t_small_union_find<N>::same_set_batch(_input_iterator first, _input_iterator last, _output_iterator out)const
+  {
+    for(; first != last; ++first, ++out)
+      {
+	vertex_t pair[2] = {vertex_t(std::get<0>(*first)), vertex_t(std::get<1>(*first))};
+	this->find_batch(pair, pair + 2, pair);
+	*out = pair[0] == pair[1];
+      }
+    return out;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR bool t_small_union_find<N>::empty(void)const
+  {
+    return this->m_size == 0;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR std::size_t t_small_union_find<N>::size(void)const
+  {
+    return this->m_size;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR std::size_t t_small_union_find<N>::number_of_independent_sets(void)const
+  {
+    return this->m_nb_cc;
+  }
+
+  template <std::size_t N>
+  template<class _output_iterator>
+  _output_iterator t_small_union_find<N>::leaders(_output_iterator out)
+  {
+    for(count_t u = 0; u < this->m_size; u++)
+      if(this->m_parents[u] == u)
+	*out++ = vertex_t(u);
+    return out;
+  }
+
+  template <std::size_t N>
+  template<class _output_iterator>
+  _output_iterator t_small_union_find<N>::independent_set(vertex_t u, _output_iterator out)
+  {
+    if(WITH_MASKS)
+      {
+	for(mask_t set = this->mask(this->find_set(u)); set != 0; set &= set - 1)
+	  *out++ = lowest_bit(set);
+	return out;
+      }
+    u = this->find_set(u);
+    for(count_t v = 0; v < this->m_size; v++)
+      if(u == this->find_set(vertex_t(v)))
+	*out++ = vertex_t(v);
+    return out;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR std::size_t t_small_union_find<N>::set_size(vertex_t u)
+  {
+    if(WITH_MASKS)
+      return count_bits(this->mask(this->find_set(u)));
+    u = this->find_set(u);
+    std::size_t size = 0;
+    for(count_t v = 0; v < this->m_size; v++)
+      if(u == this->find_set(vertex_t(v)))
+	size++;
+    return size;
+  }
+
+  template <std::size_t N>
+  UTILS_UNION_FIND_CONSTEXPR std::uint64_t t_small_union_find<N>::set_mask(vertex_t u)
+  {
+    static_assert(WITH_MASKS, "the set masks need N <= 64");
+    return this->mask(this->find_set(u));
+  }
+
+}//end namespace utils
+
+#endif
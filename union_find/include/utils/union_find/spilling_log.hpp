@@ -0,0 +1,402 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_SPILLING_LOG_HPP_
+#define _UTILS_UNION_FIND_SPILLING_LOG_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <utils/union_find/allocator.hpp>
+#include <utils/union_find/operation_log.hpp>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+namespace utils{
+  /*
+    Log of the operations of a Union-Find structure with the Rewind
+    feature, in the format of t_operation_log, keeping at most
+    HOT_WORDS words in memory : when the memory is full, its oldest
+    half is written at the end of a temporary file, and when the
+    rewind reaches the start of the memory, the last half block of the
+    file is read back in front of it. The file is only written and
+    read sequentially by blocks of HOT_WORDS / 2 words, so that the
+    push and the rewind of an operation stay O(1) amortized.
+
+    The paths of the finds are split in entries of at most
+    HOT_WORDS / 4 operands, so that an entry read back always fits in
+    the memory. The file is created on the first spill in $TMPDIR (or
+    /tmp), and removed from the directory at once so that nothing is
+    left after the process.
+
+    The memory is only spilled before an entry is pushed, with room
+    for the whole entry. If the file cannot be created or written,
+    std::runtime_error is thrown by the push of the entry : the entry
+    is not recorded while its operation has been applied, so that the
+    rewind is only exact back to the previous entries. If the file
+    cannot be read back, std::runtime_error is thrown by back() and the
+    log is left unchanged.
+  */
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator = std::allocator<_word> >
+  class t_spilling_operation_log{
+
+    //Types
+
+  public:
+
+    typedef _word                                    word_t;
+    typedef typename t_operation_log<_word>::entry_t entry_t;
+
+    static const unsigned TAG_BITS     = t_operation_log<_word>::TAG_BITS;
+    static const unsigned FLAG_BIT     = t_operation_log<_word>::FLAG_BIT;
+    static const unsigned LENGTH_SHIFT = t_operation_log<_word>::LENGTH_SHIFT;
+    static const unsigned FIND_SET_TAG = t_operation_log<_word>::FIND_SET_TAG;
+
+    static const std::size_t BLOCK_WORDS = HOT_WORDS / 2;
+
+    static_assert(HOT_WORDS >= 64, "the memory of the log holds at least 64 words");
+
+    //Attributes
+
+  private:
+
+    typename t_allocator_vector<word_t, _allocator>::type m_words;//words from m_base to the end
+    std::size_t                                           m_base;//number of words in the file
+    std::size_t                                           m_path_begin;//start of the find set entry being recorded
+    std::FILE*                                            m_file;
+
+    //Constructors
+
+  public:
+
+    t_spilling_operation_log(void) : m_words(), m_base(0), m_path_begin(0), m_file(nullptr) {}
+
+    //the file cannot be shared
+    t_spilling_operation_log(const t_spilling_operation_log&) = delete;
+    t_spilling_operation_log& operator=(const t_spilling_operation_log&) = delete;
+
+    t_spilling_operation_log(t_spilling_operation_log&& log)
+      : m_words(std::move(log.m_words)),
+	m_base(log.m_base),
+	m_path_begin(log.m_path_begin),
+	m_file(log.m_file)
+    {
+      log.m_base = 0;
+      log.m_file = nullptr;
+    }
+
+    t_spilling_operation_log& operator=(t_spilling_operation_log&& log)
+    {
+      std::swap(this->m_words, log.m_words);
+      std::swap(this->m_base, log.m_base);
+      std::swap(this->m_path_begin, log.m_path_begin);
+      std::swap(this->m_file, log.m_file);
+      return *this;
+    }
+
+    ~t_spilling_operation_log(void)
+    {
+      if(this->m_file != nullptr)
+	std::fclose(this->m_file);
+    }
+
+    //Internal
+
+  private:
+
+    static std::size_t max_length(void){return std::min<std::size_t>(std::numeric_limits<word_t>::max() >> LENGTH_SHIFT, HOT_WORDS / 4);}
+
+    //creates the temporary file, returns false on failure
+    bool open(void);
+
+    //writes the oldest block of the memory at the end of the file,
+    //throws std::runtime_error on failure
+    void spill(void);
+
+    //reads the last block of the file in front of the memory, so that
+    //it holds at least n words (O(n) amortized), throws
+    //std::runtime_error on failure
+    void page_in(std::size_t n);
+
+    //removes the words after the n first ones (O(1))
+    void truncate(std::size_t n);
+
+    //spills the memory if the n next words do not fit in it
+    void make_room(std::size_t n)
+    {
+      if(this->m_words.size() + n > HOT_WORDS)
+	this->spill();
+    }
+
+    void push_word(word_t u)
+    {
+      assert(this->m_words.size() < HOT_WORDS);
+      this->m_words.push_back(u);
+    }
+
+    void push_trailer(unsigned tag, bool flag, std::size_t length)
+    {
+      assert(length <= max_length());
+      this->push_word(word_t((word_t(length) << LENGTH_SHIFT) | (word_t(flag) << FLAG_BIT) | word_t(tag)));
+    }
+
+    //Operations
+
+  public:
+
+    //returns true iff there is no entry (O(1))
+    bool empty(void)const{return this->size() == 0;}
+
+    //returns the number of words in the log, in memory and in the file
+    //(O(1))
+    std::size_t size(void)const{return this->m_base + this->m_words.size();}
+
+    //returns the memory allocated by the log in bytes, at most
+    //HOT_WORDS words once the file is used (O(1))
+    std::size_t memory(void)const{return this->m_words.capacity() * sizeof(word_t);}
+
+    //returns the number of words in the file (O(1))
+    std::size_t spilled(void)const{return this->m_base;}
+
+    //allocates the memory for n words, up to HOT_WORDS (O(n))
+    void reserve(std::size_t n){this->m_words.reserve(std::min(n, HOT_WORDS));}
+
+    //removes all entries, the file being reused (O(1))
+    void clear(void){this->truncate(0);}
+
+    //writes all the words at the position of the file (O(n))
+    bool write(std::FILE* file)const;
+
+    //replaces the log by n words read at the position of the file
+    //(O(n)), throws std::runtime_error if they cannot be spilled
+    bool read(std::FILE* file, std::size_t n);
+
+    //records an operation with no operand
+    void push(unsigned tag, bool flag)
+    {
+      this->make_room(1);
+      this->push_trailer(tag, flag, 0);
+    }
+
+    //records an operation with two or three operands
+    void push(unsigned tag, bool flag, word_t u, word_t v)
+    {
+      this->make_room(3);
+      this->push_word(u);
+      this->push_word(v);
+      this->push_trailer(tag, flag, 2);
+    }
+
+    void push(unsigned tag, bool flag, word_t u, word_t v, word_t w)
+    {
+      this->make_room(4);
+      this->push_word(u);
+      this->push_word(v);
+      this->push_word(w);
+      this->push_trailer(tag, flag, 3);
+    }
+
+    //starts recording the path of a find set, with room for its
+    //longest entry
+    void begin_path(void)
+    {
+      this->make_room(max_length() + 1);
+      this->m_path_begin = this->size();
+    }
+
+    //adds a vertex to the path of the find set, splitting too long
+    //paths in several entries sharing one vertex
+    void push_path(word_t u)
+    {
+      if(this->size() - this->m_path_begin == max_length())
+	{
+	  word_t last = this->m_words.back();
+	  this->push_trailer(FIND_SET_TAG, false, max_length());
+	  this->make_room(max_length() + 1);
+	  this->m_path_begin = this->size();
+	  this->push_word(last);
+	}
+      this->push_word(u);
+    }
+
+    //ends recording the path of a find set, the path is dropped if no
+    //parent was changed
+    void end_path(void)
+    {
+      std::size_t length = this->size() - this->m_path_begin;
+      if(length < 2)
+	this->truncate(this->m_path_begin);
+      else
+	this->push_trailer(FIND_SET_TAG, false, length);
+    }
+
+    //reads the last entry, reading the file back if needed (O(1)
+    //amortized), throws std::runtime_error if the file cannot be read
+    entry_t back(void);
+
+    //removes the last entry (O(1) amortized)
+    void pop_back(void)
+    {
+      this->truncate(this->size() - 1 - this->back().length);
+    }
+
+  };//end class t_spilling_operation_log
+
+  //Implementation
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  const unsigned t_spilling_operation_log<_word, HOT_WORDS, _allocator>::TAG_BITS;
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  const unsigned t_spilling_operation_log<_word, HOT_WORDS, _allocator>::FLAG_BIT;
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  const unsigned t_spilling_operation_log<_word, HOT_WORDS, _allocator>::LENGTH_SHIFT;
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  const unsigned t_spilling_operation_log<_word, HOT_WORDS, _allocator>::FIND_SET_TAG;
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  const std::size_t t_spilling_operation_log<_word, HOT_WORDS, _allocator>::BLOCK_WORDS;
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  bool t_spilling_operation_log<_word, HOT_WORDS, _allocator>::open(void)
+  {
+    if(this->m_file != nullptr)
+      return true;
+#if defined(__unix__)
+    const char* directory = std::getenv("TMPDIR");
+    std::string path = std::string(directory != nullptr && *directory != '\0' ? directory : "/tmp") + "/union_find_log_XXXXXX";
+    int fd = ::mkstemp(&path[0]);
+    if(fd < 0)
+      return false;
+    ::unlink(path.c_str());
+    this->m_file = ::fdopen(fd, "w+b");
+    if(this->m_file == nullptr)
+      ::close(fd);
+#else
+    this->m_file = std::tmpfile();
+#endif
+    return this->m_file != nullptr;
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  void t_spilling_operation_log<_word, HOT_WORDS, _allocator>::spill(void)
+  {
+    if(!this->open())
+      throw std::runtime_error("t_spilling_operation_log : cannot create the file of the log");
+    if(std::fseek(this->m_file, long(this->m_base * sizeof(word_t)), SEEK_SET) != 0
+       || std::fwrite(this->m_words.data(), sizeof(word_t), BLOCK_WORDS, this->m_file) != BLOCK_WORDS)
+      throw std::runtime_error("t_spilling_operation_log : cannot write the file of the log");
+    this->m_words.erase(this->m_words.begin(), this->m_words.begin() + BLOCK_WORDS);
+    this->m_base += BLOCK_WORDS;
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  void t_spilling_operation_log<_word, HOT_WORDS, _allocator>::page_in(std::size_t n)
+  {
+    assert(n <= this->size());
+    if(this->m_words.size() >= n)
+      return;
+
+    std::size_t count = std::min(this->m_base, std::max(BLOCK_WORDS, n - this->m_words.size()));
+    this->m_words.insert(this->m_words.begin(), count, word_t());
+    this->m_base -= count;
+    if(std::fseek(this->m_file, long(this->m_base * sizeof(word_t)), SEEK_SET) != 0
+       || std::fread(this->m_words.data(), sizeof(word_t), count, this->m_file) != count)
+      {
+	this->m_words.erase(this->m_words.begin(), this->m_words.begin() + count);
+	this->m_base += count;
+	throw std::runtime_error("t_spilling_operation_log : cannot read the file of the log");
+      }
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  void t_spilling_operation_log<_word, HOT_WORDS, _allocator>::truncate(std::size_t n)
+  {
+    if(n >= this->m_base)
+      this->m_words.resize(n - this->m_base);
+    else
+      {
+	this->m_words.clear();
+	this->m_base = n;
+      }
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  bool t_spilling_operation_log<_word, HOT_WORDS, _allocator>::write(std::FILE* file)const
+  {
+    //the file is copied by blocks
+    std::vector<word_t> block(std::min(this->m_base, BLOCK_WORDS));
+    for(std::size_t position = 0; position < this->m_base; position += block.size())
+      {
+	std::size_t count = std::min(block.size(), this->m_base - position);
+	if(std::fseek(this->m_file, long(position * sizeof(word_t)), SEEK_SET) != 0
+	   || std::fread(block.data(), sizeof(word_t), count, this->m_file) != count
+	   || std::fwrite(block.data(), sizeof(word_t), count, file) != count)
+	  return false;
+      }
+    return std::fwrite(this->m_words.data(), sizeof(word_t), this->m_words.size(), file) == this->m_words.size();
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  bool t_spilling_operation_log<_word, HOT_WORDS, _allocator>::read(std::FILE* file, std::size_t n)
+  {
+    this->clear();
+    std::vector<word_t> block(std::min(n, BLOCK_WORDS));
+    for(std::size_t position = 0; position < n; position += block.size())
+      {
+	std::size_t count = std::min(block.size(), n - position);
+	if(std::fread(block.data(), sizeof(word_t), count, file) != count)
+	  {
+	    this->clear();
+	    return false;
+	  }
+	for(std::size_t i = 0; i < count; i++)
+	  {
+	    this->make_room(1);
+	    this->push_word(block[i]);
+	  }
+      }
+    return true;
+  }
+
+  template <class _word, std::size_t HOT_WORDS, class _allocator>
+  typename t_spilling_operation_log<_word, HOT_WORDS, _allocator>::entry_t t_spilling_operation_log<_word, HOT_WORDS, _allocator>::back(void)
+  {
+    assert(!this->empty());
+    this->page_in(1);
+    word_t trailer = this->m_words.back();
+    entry_t entry;
+    entry.tag = unsigned(trailer & ((word_t(1) << TAG_BITS) - 1));
+    entry.flag = ((trailer >> FLAG_BIT) & 1) != 0;
+    entry.length = std::size_t(trailer >> LENGTH_SHIFT);
+    this->page_in(entry.length + 1);
+    entry.operands = this->m_words.data() + this->m_words.size() - 1 - entry.length;
+    return entry;
+  }
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,116 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_STATS_HPP_
+#define _UTILS_UNION_FIND_STATS_HPP_
+
+#include <cstddef>
+#include <ostream>
+
+namespace utils{
+  /*
+    Statistics of a Union-Find structure with the t_stats policy,
+    returned by t_union_find::stats(). The counters cover the
+    operations since the creation of the structure or the last
+    reset_stats(), the histograms are indexed by buckets of powers of
+    2 : the bucket of x is its number of bits, i.e. 0 for 0, 1 for 1,
+    2 for 2 and 3, 3 for 4 to 7, etc.
+  */
+
+  struct t_union_find_stats{
+
+    static const std::size_t NB_BUCKETS = 65;
+
+    std::size_t nb_make_sets;
+    std::size_t nb_finds;//including the two finds of each union
+    std::size_t nb_path_vertices;//vertices walked below the leaders by the finds
+    std::size_t nb_compression_writes;//parents rewritten by the compression policy
+    std::size_t nb_unions;
+    std::size_t nb_failed_unions;//of two vertices already in the same set
+    std::size_t nb_rewinds;//operations rewinded
+    std::size_t log_words;//current size of the log
+    std::size_t peak_log_words;//largest size of the log
+    std::size_t log_bytes;//memory allocated by the log
+    std::size_t path_lengths[NB_BUCKETS];//finds by bucket of the number of vertices walked
+    std::size_t weights[NB_BUCKETS];//leaders by rank with t_link_by_rank, by bucket of their size with t_link_by_size
+
+    t_union_find_stats(void)
+      : nb_make_sets(0),
+	nb_finds(0),
+	nb_path_vertices(0),
+	nb_compression_writes(0),
+	nb_unions(0),
+	nb_failed_unions(0),
+	nb_rewinds(0),
+	log_words(0),
+	peak_log_words(0),
+	log_bytes(0),
+	path_lengths(),
+	weights()
+    {
+    }
+
+    //returns the bucket of x (O(log x))
+    static std::size_t bucket(std::size_t x)
+    {
+      std::size_t b = 0;
+      for(; x != 0; x >>= 1)
+	b++;
+      return b;
+    }
+
+    //returns the average number of vertices walked by a find (O(1))
+    double mean_path_length(void)const
+    {
+      return this->nb_finds > 0 ? double(this->nb_path_vertices) / double(this->nb_finds) : 0;
+    }
+
+    //writes the statistics as a JSON object, the histograms being
+    //arrays up to their last non-empty bucket (O(1))
+    void write_json(std::ostream& out)const
+    {
+      out << "{\"make_sets\": " << this->nb_make_sets
+	  << ", \"finds\": " << this->nb_finds
+	  << ", \"path_vertices\": " << this->nb_path_vertices
+	  << ", \"compression_writes\": " << this->nb_compression_writes
+	  << ", \"unions\": " << this->nb_unions
+	  << ", \"failed_unions\": " << this->nb_failed_unions
+	  << ", \"rewinds\": " << this->nb_rewinds
+	  << ", \"log_words\": " << this->log_words
+	  << ", \"peak_log_words\": " << this->peak_log_words
+	  << ", \"log_bytes\": " << this->log_bytes;
+      write_histogram(out, "path_lengths", this->path_lengths);
+      write_histogram(out, "weights", this->weights);
+      out << "}";
+    }
+
+  private:
+
+    static void write_histogram(std::ostream& out, const char* name, const std::size_t* histogram)
+    {
+      std::size_t n = NB_BUCKETS;
+      while(n > 0 && histogram[n - 1] == 0)
+	n--;
+      out << ", \"" << name << "\": [";
+      for(std::size_t i = 0; i < n; i++)
+	out << (i > 0 ? ", " : "") << histogram[i];
+      out << "]";
+    }
+
+  };//end struct t_union_find_stats
+
+}//end namespace utils
+
+#endif
@@ -0,0 +1,493 @@
+/*
+Copyright 2018 Tom Dreyfus, Redant Labs SAS
+
+Licensed under the Apache License, Version 2.0 (the "License"); you
+may not use this file except in compliance with the License.  You may
+obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+implied.  See the License for the specific language governing
+permissions and limitations under the License.
+*/
+#ifndef _UTILS_UNION_FIND_STORAGE_HPP_
+#define _UTILS_UNION_FIND_STORAGE_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <utils/union_find/allocator.hpp>
+
+namespace utils{
+  /*
+    Storages of the forest of a Union-Find structure. The storage
+    t_union_find_storage keeps one parent per vertex, a leader being
+    its own parent, and one weight per vertex (rank or size) that is
+    only meaningful for the leaders. The weights are not stored if the
+    linking policy does not use them.
+
+    The storage t_union_find_packed_storage keeps only one word per
+    vertex : the parent for a vertex that is not a leader, and the
+    weight with the highest bit set for a leader. The weight of a
+    vertex is lost when it is linked below another leader, so
+    WEIGHTS_IN_PARENTS tells that a rewind has to restore it.
+
+    The storage t_union_find_lazy_storage wraps one of them to reset
+    all the vertices in O(1) (see t_lazy_reset).
+
+    The arrays are allocated by _allocator, rebound to the type of
+    each array (see t_allocator).
+  */
+
+  template <class _vertex, class _weight, bool WITH_WEIGHTS, class _allocator = std::allocator<_vertex> >
+  class t_union_find_storage{
+
+    //Types
+
+  public:
+
+    typedef _vertex    vertex_t;
+    typedef _weight    weight_t;
+    typedef _allocator allocator_type;
+
+    static const bool WEIGHTS_IN_PARENTS = false;
+
+    //Attributes
+
+  private:
+
+    typename t_allocator_vector<vertex_t, _allocator>::type m_parents;
+    typename t_allocator_vector<weight_t, _allocator>::type m_weights;
+
+    //Operations
+
+  public:
+
+    //returns the maximum number of vertices (O(1))
+    static std::size_t max_size(void){return std::numeric_limits<vertex_t>::max();}
+
+    //returns the number of vertices (O(1))
+    std::size_t size(void)const{return this->m_parents.size();}
+
+    //removes all vertices (O(n))
+    void clear(void){this->m_parents.clear(); this->m_weights.clear();}
+
+    //reserves the memory for n vertices (O(n))
+    void reserve(std::size_t n)
+    {
+      this->m_parents.reserve(n);
+      if(WITH_WEIGHTS)
+	this->m_weights.reserve(n);
+    }
+
+    //adds a new leader with weight w (O(1))
+    void push_back(weight_t w)
+    {
+      this->m_parents.push_back(vertex_t(this->size()));
+      if(WITH_WEIGHTS)
+	this->m_weights.push_back(w);
+    }
+
+    //adds n new leaders with weight w (O(n))
+    void grow(std::size_t n, weight_t w)
+    {
+      std::size_t size = this->size();
+      this->m_parents.resize(size + n);
+      std::iota(this->m_parents.begin() + size, this->m_parents.end(), vertex_t(size));
+      if(WITH_WEIGHTS)
+	this->m_weights.resize(size + n, w);
+    }
+
+    //turns all the vertices into leaders with weight w (O(n))
+    void reset(weight_t w)
+    {
+      std::iota(this->m_parents.begin(), this->m_parents.end(), vertex_t(0));
+      if(WITH_WEIGHTS)
+	std::fill(this->m_weights.begin(), this->m_weights.end(), w);
+    }
+
+    //removes the last vertex (O(1))
+    void pop_back(void)
+    {
+      this->m_parents.pop_back();
+      if(WITH_WEIGHTS)
+	this->m_weights.pop_back();
+    }
+
+    //turns u into a leader with weight w (O(1))
+    void make_root(vertex_t u, weight_t w)
+    {
+      this->m_parents[u] = u;
+      if(WITH_WEIGHTS)
+	this->m_weights[u] = w;
+    }
+
+    vertex_t parent(vertex_t u)const{return this->m_parents[u];}
+
+    void set_parent(vertex_t u, vertex_t p){this->m_parents[u] = p;}
+
+    weight_t weight(vertex_t u)const{return WITH_WEIGHTS ? this->m_weights[u] : weight_t();}
+
+    void set_weight(vertex_t u, weight_t w)
+    {
+      if(WITH_WEIGHTS)
+	this->m_weights[u] = w;
+    }
+
+    //Raw arrays, for serialization
+
+    //resizes the arrays without setting the new vertices (O(n))
+    void resize(std::size_t n)
+    {
+      this->m_parents.resize(n);
+      if(WITH_WEIGHTS)
+	this->m_weights.resize(n);
+    }
+
+    //the arrays are up to date
+    void materialize(void)const{}
+
+    vertex_t* parents_data(void){return this->m_parents.data();}
+    const vertex_t* parents_data(void)const{return this->m_parents.data();}
+
+    //null if the weights are not stored
+    weight_t* weights_data(void){return WITH_WEIGHTS ? this->m_weights.data() : nullptr;}
+    const weight_t* weights_data(void)const{return WITH_WEIGHTS ? this->m_weights.data() : nullptr;}
+
+  };//end class t_union_find_storage
+
+  template <class _vertex, class _weight, class _allocator = std::allocator<_vertex> >
+  class t_union_find_packed_storage{
+
+    //Types
+
+  public:
+
+    typedef _vertex    vertex_t;
+    typedef _weight    weight_t;
+    typedef _allocator allocator_type;
+
+    static const bool WEIGHTS_IN_PARENTS = true;
+
+  private:
+
+    static const vertex_t ROOT_FLAG = vertex_t(1) << (std::numeric_limits<vertex_t>::digits - 1);
+
+    //slot of a leader with weight w, that must leave the flag free
+    static vertex_t root_slot(weight_t w)
+    {
+      assert(vertex_t(w) < ROOT_FLAG);
+      return ROOT_FLAG | vertex_t(w);
+    }
+
+    //Attributes
+
+  private:
+
+    typename t_allocator_vector<vertex_t, _allocator>::type m_slots;
+
+    //Operations
+
+  public:
+
+    //returns the maximum number of vertices, so that a size fits
+    //below the flag (O(1))
+    static std::size_t max_size(void){return ROOT_FLAG - 1;}
+
+    //returns the number of vertices (O(1))
+    std::size_t size(void)const{return this->m_slots.size();}
+
+    //removes all vertices (O(n))
+    void clear(void){this->m_slots.clear();}
+
+    //reserves the memory for n vertices (O(n))
+    void reserve(std::size_t n){this->m_slots.reserve(n);}
+
+    //adds a new leader with weight w (O(1))
+    void push_back(weight_t w){this->m_slots.push_back(root_slot(w));}
+
+    //adds n new leaders with weight w (O(n))
+    void grow(std::size_t n, weight_t w){this->m_slots.resize(this->size() + n, root_slot(w));}
+
+    //turns all the vertices into leaders with weight w (O(n))
+    void reset(weight_t w){std::fill(this->m_slots.begin(), this->m_slots.end(), root_slot(w));}
+
+    //removes the last vertex (O(1))
+    void pop_back(void){this->m_slots.pop_back();}
+
+    //turns u into a leader with weight w (O(1))
+    void make_root(vertex_t u, weight_t w){this->m_slots[u] = root_slot(w);}
+
+    vertex_t parent(vertex_t u)const
+    {
+      vertex_t slot = this->m_slots[u];
+      return (slot & ROOT_FLAG) ? u : slot;
+    }
+
+    void set_parent(vertex_t u, vertex_t p){this->m_slots[u] = p;}
+
+    weight_t weight(vertex_t u)const{return weight_t(this->m_slots[u] & ~ROOT_FLAG);}
+
+    void set_weight(vertex_t u, weight_t w){this->m_slots[u] = root_slot(w);}
+
+    //Raw arrays, for serialization
+
+    //resizes the array without setting the new vertices (O(n))
+    void resize(std::size_t n){this->m_slots.resize(n);}
+
+    //the array is up to date
+    void materialize(void)const{}
+
+    vertex_t* parents_data(void){return this->m_slots.data();}
+    const vertex_t* parents_data(void)const{return this->m_slots.data();}
+
+    weight_t* weights_data(void){return nullptr;}
+    const weight_t* weights_data(void)const{return nullptr;}
+
+  };//end class t_union_find_packed_storage
+
+  /*
+    Lazy reset of a storage : each vertex carries the generation of
+    its last write, and reset() only starts a new generation. A vertex
+    of an older generation reads as a leader with the initial weight,
+    and is rewritten on its first change, so that the vertices that
+    are not touched after a reset cost nothing. The stamps take 4
+    bytes per vertex, and are all rewritten once every 2^32 resets.
+  */
+
+  template <class _storage>
+  class t_union_find_lazy_storage{
+
+    //Types
+
+  public:
+
+    typedef typename _storage::vertex_t       vertex_t;
+    typedef typename _storage::weight_t       weight_t;
+    typedef typename _storage::allocator_type allocator_type;
+
+    static const bool WEIGHTS_IN_PARENTS = _storage::WEIGHTS_IN_PARENTS;
+
+    //Attributes
+
+  private:
+
+    typedef typename t_allocator_vector<std::uint32_t, allocator_type>::type stamps_t;
+
+    //mutable for materialize, that does not change the content
+    mutable _storage m_base;
+    mutable stamps_t m_stamps;//generation of the last write of each vertex
+    std::uint32_t    m_generation;
+    weight_t         m_initial_weight;//weight of the vertices of older generations
+
+    //Internal
+
+  private:
+
+    bool fresh(vertex_t u)const{return this->m_stamps[u] == this->m_generation;}
+
+    //rewrites u if it belongs to an older generation
+    void touch(vertex_t u)const
+    {
+      if(!this->fresh(u))
+	{
+	  this->m_base.make_root(u, this->m_initial_weight);
+	  this->m_stamps[u] = this->m_generation;
+	}
+    }
+
+    //Operations
+
+  public:
+
+    t_union_find_lazy_storage(void) : m_base(), m_stamps(), m_generation(0), m_initial_weight() {}
+
+    //returns the maximum number of vertices (O(1))
+    static std::size_t max_size(void){return _storage::max_size();}
+
+    //returns the number of vertices (O(1))
+    std::size_t size(void)const{return this->m_base.size();}
+
+    //removes all vertices (O(n))
+    void clear(void){this->m_base.clear(); this->m_stamps.clear();}
+
+    //reserves the memory for n vertices (O(n))
+    void reserve(std::size_t n){this->m_base.reserve(n); this->m_stamps.reserve(n);}
+
+    //adds a new leader with weight w (O(1))
+    void push_back(weight_t w){this->m_base.push_back(w); this->m_stamps.push_back(this->m_generation);}
+
+    //adds n new leaders with weight w (O(n))
+    void grow(std::size_t n, weight_t w){this->m_base.grow(n, w); this->m_stamps.resize(this->size(), this->m_generation);}
+
+    //turns all the vertices into leaders with weight w (O(1))
+    void reset(weight_t w)
+    {
+      this->m_initial_weight = w;
+      if(++this->m_generation == 0)
+	{
+	  std::fill(this->m_stamps.begin(), this->m_stamps.end(), 0);
+	  this->m_generation = 1;
+	}
+    }
+
+    //removes the last vertex (O(1))
+    void pop_back(void){this->m_base.pop_back(); this->m_stamps.pop_back();}
+
+    //turns u into a leader with weight w (O(1))
+    void make_root(vertex_t u, weight_t w){this->m_base.make_root(u, w); this->m_stamps[u] = this->m_generation;}
+
+    vertex_t parent(vertex_t u)const{return this->fresh(u) ? this->m_base.parent(u) : u;}
+
+    void set_parent(vertex_t u, vertex_t p){this->touch(u); this->m_base.set_parent(u, p);}
+
+    weight_t weight(vertex_t u)const{return this->fresh(u) ? this->m_base.weight(u) : this->m_initial_weight;}
+
+    void set_weight(vertex_t u, weight_t w){this->touch(u); this->m_base.set_weight(u, w);}
+
+    //Raw arrays, for serialization
+
+    //resizes the arrays without setting the vertices, that all belong
+    //to the current generation (O(n))
+    void resize(std::size_t n){this->m_base.resize(n); this->m_stamps.assign(n, this->m_generation);}
+
+    //rewrites the vertices of older generations, so that the raw
+    //arrays are up to date (O(n))
+    void materialize(void)const
+    {
+      for(std::size_t u = 0; u < this->size(); u++)
+	this->touch(vertex_t(u));
+    }
+
+    vertex_t* parents_data(void){return this->m_base.parents_data();}
+    const vertex_t* parents_data(void)const{return this->m_base.parents_data();}
+
+    weight_t* weights_data(void){return this->m_base.weights_data();}
+    const weight_t* weights_data(void)const{return this->m_base.weights_data();}
+
+  };//end class t_union_find_lazy_storage
+
+  /*
+    Storage counting the writes of the parents, for the statistics :
+    the other operations are the ones of the storage it derives from.
+  */
+
+  template <class _storage>
+  class t_union_find_counting_storage : public _storage{
+
+    //Types
+
+  public:
+
+    typedef typename _storage::vertex_t vertex_t;
+
+    //Attributes
+
+  private:
+
+    std::size_t m_parent_writes;
+
+    //Operations
+
+  public:
+
+    t_union_find_counting_storage(void) : _storage(), m_parent_writes(0) {}
+
+    void set_parent(vertex_t u, vertex_t p){this->m_parent_writes++; _storage::set_parent(u, p);}
+
+    //returns the number of calls to set_parent (O(1))
+    std::size_t parent_writes(void)const{return this->m_parent_writes;}
+
+  };//end class t_union_find_counting_storage
+
+  /*
+    Views of the arrays of a storage in memory they do not own (e.g. a
+    mapped file), with the same interface as the storages except that
+    the number of vertices is fixed.
+  */
+
+  template <class _vertex, class _weight, bool WITH_WEIGHTS>
+  class t_union_find_storage_view{
+
+  public:
+
+    typedef _vertex vertex_t;
+    typedef _weight weight_t;
+
+  private:
+
+    vertex_t*   m_parents;
+    weight_t*   m_weights;
+    std::size_t m_size;
+
+  public:
+
+    t_union_find_storage_view(vertex_t* parents = nullptr, weight_t* weights = nullptr, std::size_t size = 0)
+      : m_parents(parents), m_weights(weights), m_size(size) {}
+
+    std::size_t size(void)const{return this->m_size;}
+
+    vertex_t parent(vertex_t u)const{return this->m_parents[u];}
+
+    void set_parent(vertex_t u, vertex_t p){this->m_parents[u] = p;}
+
+    weight_t weight(vertex_t u)const{return WITH_WEIGHTS ? this->m_weights[u] : weight_t();}
+
+    void set_weight(vertex_t u, weight_t w)
+    {
+      if(WITH_WEIGHTS)
+	this->m_weights[u] = w;
+    }
+
+  };//end class t_union_find_storage_view
+
+  template <class _vertex, class _weight>
+  class t_union_find_packed_storage_view{
+
+  public:
+
+    typedef _vertex vertex_t;
+    typedef _weight weight_t;
+
+  private:
+
+    static const vertex_t ROOT_FLAG = vertex_t(1) << (std::numeric_limits<vertex_t>::digits - 1);
+
+    vertex_t*   m_slots;
+    std::size_t m_size;
+
+  public:
+
+    t_union_find_packed_storage_view(vertex_t* slots = nullptr, weight_t* = nullptr, std::size_t size = 0)
+      : m_slots(slots), m_size(size) {}
+
+    std::size_t size(void)const{return this->m_size;}
+
+    vertex_t parent(vertex_t u)const
+    {
+      vertex_t slot = this->m_slots[u];
+      return (slot & ROOT_FLAG) ? u : slot;
+    }
+
+    void set_parent(vertex_t u, vertex_t p){this->m_slots[u] = p;}
+
+    weight_t weight(vertex_t u)const{return weight_t(this->m_slots[u] & ~ROOT_FLAG);}
+
+    void set_weight(vertex_t u, weight_t w)
+    {
+      assert(vertex_t(w) < ROOT_FLAG);
+      this->m_slots[u] = ROOT_FLAG | vertex_t(w);
+    }
+
+  };//end class t_union_find_packed_storage_view
+
+}//end namespace utils
+
+#endif
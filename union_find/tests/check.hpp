@@ -0,0 +1,36 @@
+#ifndef _UTILS_UNION_FIND_TESTS_CHECK_HPP_
+#define _UTILS_UNION_FIND_TESTS_CHECK_HPP_
+
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+
+//prints the failed condition and exits with a failure, also with
+//NDEBUG
+#define CHECK(condition)						\
+  do{									\
+    if(!(condition))							\
+      {									\
+	std::cerr << __FILE__ << ":" << __LINE__ << " : check failed : " << #condition << std::endl; \
+	std::exit(EXIT_FAILURE);					\
+      }									\
+  }while(false)
+
+//returns true iff the n first vertices of a and b are in the same
+//sets, compared through the leaders given by their find_set
+template <class _a, class _b>
+bool same_sets(_a& a, _b& b, std::size_t n)
+{
+  std::unordered_map<std::size_t, std::size_t> a_to_b, b_to_a;
+  for(std::size_t u = 0; u < n; u++)
+    {
+      std::size_t leader_a = std::size_t(a.find_set(u)), leader_b = std::size_t(b.find_set(u));
+      if(a_to_b.insert(std::make_pair(leader_a, leader_b)).first->second != leader_b
+	 || b_to_a.insert(std::make_pair(leader_b, leader_a)).first->second != leader_a)
+	return false;
+    }
+  return true;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include <utils/union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//the larger of two values
+struct t_max{
+  long operator()(long a, long b)const{return std::max(a, b);}
+};
+
+//checks the aggregate of each vertex against the values of its set in
+//the reference, combined from scratch
+template <class _union_find, class _combine>
+void check_aggregates(_union_find& uf, t_union_find<>& reference, const std::vector<long>& values, _combine combine)
+{
+  CHECK(uf.size() == reference.size());
+  CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+  CHECK(same_sets(uf, reference, uf.size()));
+  std::vector<long> expected(values.size());
+  std::vector<bool> seen(values.size(), false);
+  for(std::size_t u = 0; u < values.size(); u++)
+    {
+      std::size_t leader = reference.find_set(u);
+      expected[leader] = seen[leader] ? combine(expected[leader], values[u]) : values[u];
+      seen[leader] = true;
+    }
+  for(std::size_t u = 0; u < values.size(); u++)
+    CHECK(uf.aggregate(u) == expected[reference.find_set(u)]);
+}
+
+//random make_set and unions between checkpoints, the aggregates being
+//checked after the unions and after each rollback
+template <class _combine, class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, t_aggregate<long, _combine>, _policies...> union_find_t;
+
+  std::mt19937 generator(seed);
+  _combine combine;
+  union_find_t uf;
+  t_union_find<> reference;
+  std::vector<long> values;
+  for(std::size_t u = 0; u < 300; u++)
+    {
+      values.push_back(long(generator() % 2001) - 1000);
+      uf.make_set(values.back());
+      reference.make_set();
+    }
+  check_aggregates(uf, reference, values, combine);
+
+  for(std::size_t round = 0; round < 30; round++)
+    {
+      typename union_find_t::mark_t mark = uf.mark();
+      t_union_find<> reference_at_mark = reference;
+      std::vector<long> values_at_mark = values;
+
+      for(std::size_t i = 0, m = generator() % 200; i < m; i++)
+	{
+	  if(generator() % 8 == 0)
+	    {
+	      values.push_back(long(generator() % 2001) - 1000);
+	      uf.make_set(values.back());
+	      reference.make_set();
+	    }
+	  std::size_t u = generator() % uf.size(), v = generator() % uf.size();
+	  uf.union_sets(u, v);
+	  reference.union_sets(u, v);
+	}
+      check_aggregates(uf, reference, values, combine);
+
+      //every other round is kept
+      if(round % 2 == 0)
+	{
+	  uf.rollback_to(mark);
+	  reference = reference_at_mark;
+	  values = values_at_mark;
+	  check_aggregates(uf, reference, values, combine);
+	}
+      else
+	uf.commit(mark);
+    }
+
+  //reset gives back the initial values
+  uf.reset();
+  t_union_find<> singletons;
+  singletons.make_sets(values.size());
+  check_aggregates(uf, singletons, values, combine);
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<std::plus<long> >("sum", 1);
+  run<t_max, t_link_by_size, t_path_halving>("max, link by size", 2);
+  run<std::plus<long>, t_member_lists, t_vertex_index<std::uint32_t>, t_weights_in_parents>("sum, member lists, weights in parents", 3);
+
+  //make_sets gives the default value
+  t_union_find<false, t_aggregate<long, std::plus<long> > > uf;
+  uf.make_set(5);
+  uf.make_sets(2);
+  uf.union_sets(0, 2);
+  CHECK(uf.aggregate(2) == 5 && uf.aggregate(1) == 0);
+  std::cout << "default values : ok" << std::endl;
+  return 0;
+}
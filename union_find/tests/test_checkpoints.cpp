@@ -0,0 +1,121 @@
+#include <utils/union_find.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//state of a structure that does not depend on its trees : the
+//smallest vertex of the set of each vertex and the size of the set,
+//then the number of independent sets
+template <class _union_find>
+std::vector<std::size_t> snapshot(_union_find& uf)
+{
+  std::size_t n = uf.size();
+  std::vector<std::size_t> smallest(n, n);
+  for(std::size_t u = 0; u < n; u++)
+    {
+      std::size_t leader = uf.find_set(u);
+      if(smallest[leader] == n)
+	smallest[leader] = u;
+    }
+  std::vector<std::size_t> state(2 * n + 1, 0);
+  for(std::size_t u = 0; u < n; u++)
+    {
+      state[u] = smallest[uf.find_set(u)];
+      state[n + state[u]]++;
+    }
+  for(std::size_t u = 0; u < n; u++)
+    state[n + u] = state[n + state[u]];
+  state[2 * n] = uf.number_of_independent_sets();
+  return state;
+}
+
+//random make_sets, unions and finds between nested checkpoints, each
+//rollback_to being checked against the snapshot taken at its mark
+template <class _union_find>
+void run(const char* name, unsigned seed)
+{
+  typedef typename _union_find::mark_t mark_t;
+
+  std::mt19937 generator(seed);
+  _union_find uf;
+  uf.make_sets(8);
+
+  std::vector<mark_t>                     marks;
+  std::vector<std::vector<std::size_t> > snapshots;
+  for(std::size_t step = 0; step < 10000; step++)
+    {
+      unsigned operation = generator() % 100;
+      std::size_t n = uf.size();
+      if(operation < 15 && n < 400)
+	uf.make_set();
+      else if(operation < 70)
+	uf.union_sets(generator() % n, generator() % n);
+      else if(operation < 80)
+	uf.find_set(generator() % n);
+      else if(operation < 88 || marks.empty())
+	{
+	  marks.push_back(uf.mark());
+	  snapshots.push_back(snapshot(uf));
+	}
+      else if(operation < 95)
+	{
+	  //rollback to the last checkpoint or to an enclosing one, that
+	  //stays alive
+	  std::size_t i = marks.size() - 1 - (generator() % 4 == 0 ? generator() % marks.size() : 0);
+	  uf.rollback_to(marks[i]);
+	  CHECK(snapshot(uf) == snapshots[i]);
+	  marks.resize(i + 1);
+	  snapshots.resize(i + 1);
+	}
+      else
+	{
+	  //commit the last checkpoint or an enclosing one, releasing the
+	  //nested ones
+	  std::size_t i = marks.size() - 1 - (generator() % 4 == 0 ? generator() % marks.size() : 0);
+	  std::vector<std::size_t> state = snapshot(uf);
+	  uf.commit(marks[i]);
+	  CHECK(snapshot(uf) == state);
+	  marks.resize(i);
+	  snapshots.resize(i);
+	  if(marks.empty())
+	    CHECK(uf.log_size() == 0);
+	}
+    }
+
+  //unwinds all the checkpoints left
+  while(!marks.empty())
+    {
+      uf.rollback_to(marks.back());
+      CHECK(snapshot(uf) == snapshots.back());
+      uf.commit(marks.back());
+      marks.pop_back();
+      snapshots.pop_back();
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  //compression policies
+  run<t_union_find<true> >("full compression", 1);
+  run<t_union_find<true, t_path_halving> >("path halving", 2);
+  run<t_union_find<true, t_path_splitting> >("path splitting", 3);
+  run<t_union_find<true, t_no_compression> >("no compression", 4);
+
+  //linking policies
+  run<t_union_find<true, t_link_by_size> >("link by size", 5);
+  run<t_union_find<true, t_link_by_random_index, t_path_halving> >("link by random index", 6);
+
+  //storage policies
+  run<t_union_find<true, t_vertex_index<std::uint32_t>, t_weights_in_parents> >("weights in parents, by rank", 7);
+  run<t_union_find<true, t_vertex_index<std::uint16_t>, t_weights_in_parents, t_link_by_size, t_path_splitting> >("weights in parents, by size", 8);
+  run<t_union_find<true, t_member_lists, t_link_by_size> >("member lists", 9);
+  run<t_union_find<true, t_lazy_reset, t_path_halving> >("lazy reset", 10);
+  run<t_union_find<true, t_spilling_log<64>, t_weights_in_parents, t_link_by_size> >("spilling log", 11);
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/concurrent_union_find.hpp>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+//runs body(t) on nb_threads threads
+template <class _body>
+void run_threads(unsigned nb_threads, _body body)
+{
+  std::vector<std::thread> threads;
+  for(unsigned t = 0; t < nb_threads; t++)
+    threads.push_back(std::thread(body, t));
+  for(std::thread& thread : threads)
+    thread.join();
+}
+
+//random edges unioned by several threads at once, the threads sharing
+//the vertices so that the links race, then checked against the serial
+//reference
+void run_unions(std::size_t n, std::size_t m, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<edge_t> edges;
+  t_union_find<> reference;
+  reference.make_sets(n);
+  for(std::size_t i = 0; i < m; i++)
+    {
+      edges.push_back(edge_t(generator() % n, generator() % n));
+      reference.union_sets(edges.back().first, edges.back().second);
+    }
+
+  for(unsigned nb_threads : {1u, 2u, 4u, 8u})
+    {
+      t_concurrent_union_find uf(n);
+      CHECK(uf.size() == n && uf.number_of_independent_sets() == n);
+      run_threads(nb_threads, [&uf, &edges, nb_threads](unsigned t){
+	  for(std::size_t i = t; i < edges.size(); i += nb_threads)
+	    {
+	      std::size_t leader = uf.union_sets(edges[i].first, edges[i].second);
+	      CHECK(uf.same_set(edges[i].first, leader) && uf.same_set(edges[i].second, leader));
+	    }
+	});
+      CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+      CHECK(same_sets(uf, reference, n));
+
+      //one leader per set of the reference
+      std::vector<std::size_t> leaders;
+      uf.leaders(std::back_inserter(leaders));
+      CHECK(leaders.size() == reference.number_of_independent_sets());
+      for(std::size_t u : leaders)
+	CHECK(uf.find_set(u) == u);
+
+      //concurrent queries on the final structure
+      std::vector<edge_t> queries;
+      for(std::size_t i = 0; i < 2000; i++)
+	queries.push_back(edge_t(generator() % n, generator() % n));
+      run_threads(nb_threads, [&uf, &queries, &reference, nb_threads](unsigned t){
+	  for(std::size_t i = t; i < queries.size(); i += nb_threads)
+	    CHECK(uf.same_set(queries[i].first, queries[i].second) == (reference.find_set(queries[i].first) == reference.find_set(queries[i].second)));
+	});
+    }
+}
+
+//unions racing with same_set, the unions joining even vertices or
+//odd vertices only : the queries never see an even vertex and an odd
+//one in the same set, n being even
+void run_mixed(std::size_t n, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::vector<edge_t> edges;
+  t_union_find<> reference;
+  reference.make_sets(n);
+  for(std::size_t i = 0; i < n / 2; i++)
+    {
+      std::size_t u = generator() % n, v = generator() % n;
+      if((u ^ v) & 1)
+	v ^= 1;
+      edges.push_back(edge_t(u, v));
+      reference.union_sets(edges.back().first, edges.back().second);
+    }
+
+  t_concurrent_union_find uf(n);
+  run_threads(4, [&uf, &edges](unsigned t){
+      if(t < 2)
+	for(std::size_t i = t; i < edges.size(); i += 2)
+	  uf.union_sets(edges[i].first, edges[i].second);
+      else
+	for(std::size_t i = 0; i < edges.size(); i++)
+	  CHECK(!uf.same_set(edges[i].first & ~std::size_t(1), edges[i].second | 1));
+    });
+  CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+  CHECK(same_sets(uf, reference, n));
+}
+
+int main(int argc, char** argv)
+{
+  run_unions(20000, 15000, 1);
+  run_unions(3000, 30000, 2);
+  run_unions(2, 100, 3);
+  std::cout << "concurrent unions : ok" << std::endl;
+
+  run_mixed(10000, 4);
+  std::cout << "concurrent unions and queries : ok" << std::endl;
+
+  //make_sets after the unions keeps the sets
+  t_concurrent_union_find uf(4);
+  uf.union_sets(0, 3);
+  uf.make_sets(3);
+  CHECK(uf.size() == 7 && uf.number_of_independent_sets() == 6);
+  CHECK(uf.same_set(0, 3) && !uf.same_set(3, 6));
+  std::vector<std::size_t> members;
+  uf.independent_set(3, std::back_inserter(members));
+  CHECK(members == std::vector<std::size_t>({0, 3}));
+  uf.clear();
+  CHECK(uf.empty() && uf.number_of_independent_sets() == 0);
+  std::cout << "make_sets and clear : ok" << std::endl;
+  return 0;
+}
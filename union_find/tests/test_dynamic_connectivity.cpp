@@ -0,0 +1,98 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/dynamic_connectivity.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+//random timelines of additions, removals and queries, an edge being
+//possibly added several times and removed in the other direction,
+//checked against a t_union_find rebuilt from the alive edges at each
+//query
+template <class _vertex>
+void run(const char* name, unsigned seed)
+{
+  typedef t_dynamic_connectivity<_vertex> dynamic_connectivity_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 30; iteration++)
+    {
+      std::size_t n = 1 + generator() % 40;
+      std::size_t nb_events = generator() % 1500;
+      dynamic_connectivity_t dc(n);
+      std::vector<edge_t> alive;
+      std::vector<std::size_t> queries, expected;
+      for(std::size_t i = 0; i < nb_events; i++)
+	{
+	  unsigned type = generator() % 10;
+	  if(type < 4 || (type < 6 && alive.empty()))
+	    {
+	      alive.push_back(edge_t(generator() % n, generator() % n));
+	      dc.add_edge(_vertex(alive.back().first), _vertex(alive.back().second));
+	      continue;
+	    }
+	  if(type < 6)
+	    {
+	      std::size_t j = generator() % alive.size();
+	      if(generator() % 2 == 0)
+		dc.remove_edge(_vertex(alive[j].first), _vertex(alive[j].second));
+	      else
+		dc.remove_edge(_vertex(alive[j].second), _vertex(alive[j].first));
+	      alive.erase(alive.begin() + j);
+	      continue;
+	    }
+
+	  t_union_find<> reference;
+	  reference.make_sets(n);
+	  for(const edge_t& e : alive)
+	    reference.union_sets(e.first, e.second);
+	  if(type < 9)
+	    {
+	      std::size_t u = generator() % n, v = generator() % n;
+	      queries.push_back(dc.connected(_vertex(u), _vertex(v)));
+	      expected.push_back(reference.find_set(u) == reference.find_set(v) ? 1 : 0);
+	    }
+	  else
+	    {
+	      queries.push_back(dc.count());
+	      expected.push_back(reference.number_of_independent_sets());
+	    }
+	}
+      CHECK(dc.number_of_events() == nb_events);
+      CHECK(dc.number_of_queries() == queries.size());
+
+      dc.solve();
+      for(std::size_t i = 0; i < queries.size(); i++)
+	CHECK(dc.answer(queries[i]) == expected[i]);
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<std::size_t>("default", 1);
+  run<std::uint16_t>("16 bits", 2);
+
+  //a timeline solved twice, and cleared
+  t_dynamic_connectivity<> dc(3);
+  dc.add_edge(0, 1);
+  std::size_t before = dc.connected(0, 1);
+  dc.remove_edge(1, 0);
+  std::size_t after = dc.connected(0, 1);
+  std::size_t count = dc.count();
+  for(std::size_t i = 0; i < 2; i++)
+    {
+      dc.solve();
+      CHECK(dc.answer(before) == 1 && dc.answer(after) == 0 && dc.answer(count) == 3);
+    }
+  dc.clear();
+  CHECK(dc.number_of_events() == 0 && dc.number_of_queries() == 0);
+  std::cout << "solve twice and clear : ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/edge_stream.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+typedef std::pair<std::uint32_t, std::uint32_t> edge_t;
+
+//writes the edges as text, with comments, blank lines, tabs and extra
+//columns
+void write_text(const char* path, const std::vector<edge_t>& edges)
+{
+  std::FILE* file = std::fopen(path, "w");
+  CHECK(file != nullptr);
+  std::fprintf(file, "# comment\n%% comment\n\n");
+  for(std::size_t i = 0; i < edges.size(); i++)
+    std::fprintf(file, i % 3 == 0 ? "  %u\t%u 0.5\n" : "%u %u\n", edges[i].first, edges[i].second);
+  std::fclose(file);
+}
+
+//writes the edges as binary pairs of _integer, and extra bytes
+template <class _integer>
+void write_binary(const char* path, const std::vector<edge_t>& edges, std::size_t extra = 0)
+{
+  std::FILE* file = std::fopen(path, "wb");
+  CHECK(file != nullptr);
+  for(const edge_t& e : edges)
+    {
+      _integer pair[2] = {_integer(e.first), _integer(e.second)};
+      std::fwrite(pair, sizeof(pair), 1, file);
+    }
+  for(std::size_t i = 0; i < extra; i++)
+    std::fputc(0, file);
+  std::fclose(file);
+}
+
+//streams the file with several threads and chunk sizes, some of
+//them not multiples of a pair, and compares with the reference
+void check_file(const char* path, t_edge_stream::format_t format, const std::vector<edge_t>& edges, t_union_find<>& reference)
+{
+  for(unsigned nb_threads : {1u, 2u, 4u})
+    for(std::size_t chunk_bytes : {std::size_t(1), std::size_t(100), std::size_t(1001), std::size_t(4097), std::size_t(1) << 22})
+      {
+	t_union_find<> uf;
+	t_edge_stream stream(format, nb_threads, chunk_bytes, 2);
+	CHECK(stream.union_file(path, uf));
+	CHECK(stream.number_of_edges() == edges.size());
+	CHECK(uf.size() <= reference.size());
+	CHECK(uf.number_of_independent_sets() + (reference.size() - uf.size()) == reference.number_of_independent_sets());
+	CHECK(same_sets(uf, reference, uf.size()));
+      }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = "test_edge_stream.edges";
+
+  std::mt19937 generator(1);
+  std::size_t n = 3000;
+  std::vector<edge_t> edges;
+  t_union_find<> reference;
+  reference.make_sets(n);
+  for(std::size_t i = 0; i < 5000; i++)
+    {
+      edges.push_back(edge_t(std::uint32_t(generator() % n), std::uint32_t(generator() % n)));
+      reference.union_sets(edges.back().first, edges.back().second);
+    }
+  //the last vertex is created by the last edge
+  edges.push_back(edge_t(0, std::uint32_t(n - 1)));
+  reference.union_sets(0, n - 1);
+
+  write_text(path, edges);
+  check_file(path, t_edge_stream::TEXT, edges, reference);
+  std::cout << "text : ok" << std::endl;
+
+  write_binary<std::uint32_t>(path, edges);
+  check_file(path, t_edge_stream::BINARY_32, edges, reference);
+  write_binary<std::uint64_t>(path, edges);
+  check_file(path, t_edge_stream::BINARY_64, edges, reference);
+  std::cout << "binary : ok" << std::endl;
+
+  //a truncated pair is a parse error
+  for(std::size_t extra : {std::size_t(1), std::size_t(7), std::size_t(15)})
+    {
+      write_binary<std::uint64_t>(path, edges, extra);
+      t_union_find<> uf;
+      t_edge_stream stream(t_edge_stream::BINARY_64, 1, 100);
+      CHECK(!stream.union_file(path, uf));
+    }
+  std::cout << "truncated binary : ok" << std::endl;
+
+  //a vertex out of 64 bits, or out of the vertex index, is a parse
+  //error
+  {
+    std::FILE* file = std::fopen(path, "w");
+    std::fprintf(file, "0 1\n2 18446744073709551616\n");
+    std::fclose(file);
+    t_union_find<> uf;
+    t_edge_stream stream(t_edge_stream::TEXT, 1);
+    CHECK(!stream.union_file(path, uf));
+
+    file = std::fopen(path, "w");
+    std::fprintf(file, "0 1\n2 256\n");
+    std::fclose(file);
+    t_union_find<false, t_vertex_index<std::uint8_t> > narrow;
+    CHECK(!stream.union_file(path, narrow));
+    CHECK(narrow.size() <= 256);
+  }
+  std::cout << "out of range : ok" << std::endl;
+
+  //SWAR parsing of the numbers
+  for(std::size_t i = 0; i < 100000; i++)
+    {
+      std::uint64_t value = (std::uint64_t(generator()) << 32 | generator()) >> (generator() % 64);
+      char text[32];
+      int length = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+      t_edge_stream::vertex_t parsed;
+      CHECK(t_edge_stream::parse_number(text, text + length, parsed) == text + length);
+      CHECK(parsed == value);
+    }
+  std::cout << "numbers : ok" << std::endl;
+
+  std::remove(path);
+  return 0;
+}
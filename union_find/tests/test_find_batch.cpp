@@ -0,0 +1,72 @@
+#include <utils/union_find.hpp>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//batches of every length around the window and the buffer, checked
+//against find_set on a copy, the batches leaving the structure and
+//its log unchanged
+template <bool WITH_REWIND, class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<WITH_REWIND, _policies...> union_find_t;
+  typedef typename union_find_t::vertex_t         vertex_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 20; iteration++)
+    {
+      std::size_t n = 1 + generator() % 3000;
+      union_find_t uf;
+      uf.make_sets(n);
+      for(std::size_t i = 0, m = generator() % (2 * n); i < m; i++)
+	uf.union_sets(generator() % n, generator() % n);
+      union_find_t reference = uf;
+      std::size_t log_size = uf.log_size();
+
+      for(std::size_t m : {std::size_t(0), std::size_t(1), union_find_t::FIND_WINDOW - 1, union_find_t::FIND_WINDOW + 1,
+	    union_find_t::FIND_BUFFER, union_find_t::FIND_BUFFER + 3, std::size_t(5000)})
+	{
+	  //the vertices of an input range that is not random access
+	  std::list<vertex_t> vertices;
+	  std::vector<std::pair<vertex_t, vertex_t> > pairs;
+	  for(std::size_t i = 0; i < m; i++)
+	    {
+	      vertices.push_back(vertex_t(generator() % n));
+	      pairs.push_back(std::make_pair(vertex_t(generator() % n), vertex_t(generator() % n)));
+	    }
+
+	  std::vector<vertex_t> leaders;
+	  uf.find_batch(vertices.begin(), vertices.end(), std::back_inserter(leaders));
+	  CHECK(leaders.size() == m);
+	  std::size_t i = 0;
+	  for(vertex_t u : vertices)
+	    CHECK(leaders[i++] == reference.find_set(u));
+
+	  std::vector<bool> same(m + 1, true);
+	  CHECK(uf.same_set_batch(pairs.begin(), pairs.end(), same.begin()) == same.begin() + m);
+	  CHECK(same[m]);
+	  for(i = 0; i < m; i++)
+	    CHECK(same[i] == (reference.find_set(pairs[i].first) == reference.find_set(pairs[i].second)));
+	}
+      CHECK(uf.log_size() == log_size);
+      CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<false>("default", 1);
+  run<true, t_path_halving>("rewind, path halving", 2);
+  run<false, t_vertex_index<std::uint32_t>, t_weights_in_parents, t_link_by_size>("weights in parents", 3);
+  run<false, t_lazy_reset, t_no_compression>("lazy reset", 4);
+  run<false, t_vertex_index<std::uint16_t>, t_link_by_random_index>("16 bits, random index", 5);
+  return 0;
+}
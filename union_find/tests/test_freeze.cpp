@@ -0,0 +1,141 @@
+#include <utils/union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//checks the snapshot against the structure : the labels are dense,
+//and the members of each set are its vertices in increasing order
+template <class _union_find>
+void check_snapshot(_union_find& uf, const t_frozen_union_find<typename _union_find::vertex_t>& frozen, std::size_t nb_alive)
+{
+  typedef t_frozen_union_find<typename _union_find::vertex_t> frozen_t;
+  typedef typename frozen_t::vertex_t                          vertex_t;
+
+  CHECK(frozen.size() == uf.size());
+  CHECK(frozen.number_of_independent_sets() == uf.number_of_independent_sets());
+  std::size_t nb_members = 0;
+  std::vector<std::size_t> first_of_label(frozen.number_of_independent_sets(), uf.size());
+  for(std::size_t u = 0; u < uf.size(); u++)
+    if(frozen.label(u) != frozen_t::ABSENT)
+      {
+	CHECK(frozen.label(u) < frozen.number_of_independent_sets());
+	first_of_label[frozen.label(u)] = std::min(first_of_label[frozen.label(u)], u);
+      }
+
+  std::vector<vertex_t> leaders;
+  frozen.leaders(std::back_inserter(leaders));
+  CHECK(std::equal(leaders.begin(), leaders.end(), first_of_label.begin()) && leaders.size() == first_of_label.size());
+  for(std::size_t l = 0; l < frozen.number_of_independent_sets(); l++)
+    {
+      CHECK(frozen.label_size(l) > 0);
+      CHECK(std::is_sorted(frozen.members_begin(l), frozen.members_end(l)));
+      CHECK(std::adjacent_find(frozen.members_begin(l), frozen.members_end(l)) == frozen.members_end(l));
+      for(const vertex_t* v = frozen.members_begin(l); v != frozen.members_end(l); v++)
+	{
+	  CHECK(frozen.label(*v) == l);
+	  CHECK(uf.find_set(*v) == uf.find_set(*frozen.members_begin(l)));
+	}
+      nb_members += frozen.label_size(l);
+    }
+  CHECK(nb_members == nb_alive);
+
+  //same partition as the structure, on the vertices in a set
+  for(std::size_t u = 0; u < uf.size(); u++)
+    if(frozen.label(u) != frozen_t::ABSENT)
+      {
+	CHECK(frozen.set_size(u) == frozen.label_size(frozen.label(u)));
+	CHECK(frozen.same_set(u, *frozen.members_begin(frozen.label(u))));
+      }
+}
+
+//random unions, from few large sets to almost only singletons, frozen
+//on several threads and compared with the reference
+template <class... _policies>
+void run(const char* name, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  for(std::size_t m : {std::size_t(0), std::size_t(10), std::size_t(500), std::size_t(3000), std::size_t(20000)})
+    {
+      std::size_t n = 5000;
+      t_union_find<false, _policies...> uf;
+      t_union_find<> reference;
+      uf.make_sets(n);
+      reference.make_sets(n);
+      for(std::size_t i = 0; i < m; i++)
+	{
+	  std::size_t u = generator() % n, v = generator() % n;
+	  uf.union_sets(u, v);
+	  reference.union_sets(u, v);
+	}
+      for(unsigned nb_threads : {1u, 2u, 3u, 8u})
+	{
+	  t_frozen_union_find<typename t_union_find<false, _policies...>::vertex_t> frozen = uf.freeze(nb_threads);
+	  check_snapshot(uf, frozen, n);
+	  CHECK(same_sets(uf, reference, n));
+	  for(std::size_t i = 0; i < 200; i++)
+	    {
+	      std::size_t u = generator() % n, v = generator() % n;
+	      CHECK(frozen.same_set(u, v) == (reference.find_set(u) == reference.find_set(v)));
+	    }
+	}
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+//removed vertices are absent from the snapshot, and a set whose
+//leader was removed keeps its other vertices
+void run_removal(unsigned seed)
+{
+  typedef t_frozen_union_find<std::size_t> frozen_t;
+
+  std::mt19937 generator(seed);
+  std::size_t n = 4000;
+  t_union_find<false, t_free_list, t_link_by_size> uf;
+  uf.make_sets(n);
+  for(std::size_t i = 0; i < 2500; i++)
+    uf.union_sets(generator() % n, generator() % n);
+  std::vector<bool> removed(n, false);
+  std::size_t nb_alive = n;
+  for(std::size_t i = 0; i < 1000; i++)
+    {
+      std::size_t u = generator() % n;
+      if(removed[u])
+	continue;
+      uf.remove_vertex(u);
+      removed[u] = true;
+      nb_alive--;
+    }
+
+  for(unsigned nb_threads : {1u, 2u, 8u})
+    {
+      frozen_t frozen = uf.freeze(nb_threads);
+      check_snapshot(uf, frozen, nb_alive);
+      for(std::size_t u = 0; u < n; u++)
+	{
+	  CHECK((frozen.label(u) == frozen_t::ABSENT) == removed[u]);
+	  if(removed[u])
+	    CHECK(frozen.set_size(u) == 0 && !frozen.same_set(u, u));
+	}
+    }
+  std::cout << "removed vertices : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<>("default", 1);
+  run<t_path_halving, t_link_by_size, t_vertex_index<std::uint32_t> >("path halving, link by size, 32 bits", 2);
+  run<t_member_lists>("member lists", 3);
+  run_removal(4);
+
+  t_union_find<> empty;
+  CHECK(empty.freeze().empty());
+  CHECK(empty.freeze(4).number_of_independent_sets() == 0);
+  std::cout << "empty : ok" << std::endl;
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/keyed_union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//a hash with few distinct values, so that the keys collide and share
+//the tags of their slots
+struct t_colliding_hash{
+  std::size_t operator()(std::uint64_t key)const{return std::size_t(key % 7);}
+};
+
+//the keys of a map-based reference : each key gets the next index the
+//first time it is seen, in a plain t_union_find
+template <class _key>
+struct t_reference{
+  std::map<_key, std::size_t> indices;
+  t_union_find<>              uf;
+
+  std::size_t index(const _key& key)
+  {
+    typename std::map<_key, std::size_t>::iterator i = this->indices.find(key);
+    if(i != this->indices.end())
+      return i->second;
+    this->indices[key] = this->uf.make_set();
+    return this->uf.size() - 1;
+  }
+
+  void union_keys(const _key& a, const _key& b)
+  {
+    std::size_t u = this->index(a);
+    std::size_t v = this->index(b);
+    this->uf.union_sets(u, v);
+  }
+};
+
+//random unions of keys, one by one and in batch, checked against the
+//reference on the vertices, the partition and the members
+template <class _keyed, class _make_key>
+void run(const char* name, unsigned seed, std::size_t nb_keys, _make_key make_key)
+{
+  typedef typename _keyed::key_t key_t;
+
+  std::mt19937 generator(seed);
+  _keyed uf;
+  t_reference<key_t> reference;
+  for(std::size_t i = 0; i < 3 * nb_keys; i++)
+    {
+      key_t a = make_key(generator() % nb_keys), b = make_key(generator() % nb_keys);
+      if(i % 2 == 0)
+	{
+	  uf.union_keys(a, b);
+	  reference.union_keys(a, b);
+	}
+      else
+	{
+	  std::vector<std::pair<key_t, key_t> > pairs(1, std::make_pair(a, b));
+	  for(std::size_t j = 0, nb_pairs = generator() % 40; j < nb_pairs; j++)
+	    pairs.push_back(std::make_pair(make_key(generator() % nb_keys), make_key(generator() % nb_keys)));
+	  uf.union_keys(pairs.begin(), pairs.end());
+	  for(const std::pair<key_t, key_t>& pair : pairs)
+	    reference.union_keys(pair.first, pair.second);
+	}
+    }
+
+  //the vertices are given in the order of the first occurrence of
+  //each key
+  CHECK(uf.size() == reference.indices.size());
+  CHECK(uf.number_of_independent_sets() == reference.uf.number_of_independent_sets());
+  for(const std::pair<const key_t, std::size_t>& entry : reference.indices)
+    {
+      CHECK(uf.contains(entry.first));
+      CHECK(std::size_t(uf.vertex(entry.first)) == entry.second);
+      CHECK(uf.key(uf.vertex(entry.first)) == entry.first);
+    }
+  std::map<std::size_t, std::size_t> to_reference;
+  for(const std::pair<const key_t, std::size_t>& entry : reference.indices)
+    {
+      std::size_t leader = uf.find_set(entry.first);
+      CHECK(to_reference.insert(std::make_pair(leader, reference.uf.find_set(entry.second))).first->second == reference.uf.find_set(entry.second));
+    }
+  CHECK(to_reference.size() == uf.number_of_independent_sets());
+  for(std::size_t i = 0; i < 1000; i++)
+    {
+      key_t a = make_key(generator() % nb_keys), b = make_key(generator() % nb_keys);
+      bool expected = reference.indices.count(a) && reference.indices.count(b)
+	? reference.uf.find_set(reference.indices[a]) == reference.uf.find_set(reference.indices[b])
+	: a == b;
+      CHECK(uf.same_set(a, b) == expected);
+    }
+
+  //the members of a set are the keys of the reference set
+  const key_t& key = reference.indices.begin()->first;
+  std::vector<key_t> members, expected;
+  uf.independent_set(key, std::back_inserter(members));
+  for(const std::pair<const key_t, std::size_t>& entry : reference.indices)
+    if(reference.uf.find_set(entry.second) == reference.uf.find_set(reference.indices[key]))
+      expected.push_back(entry.first);
+  std::sort(members.begin(), members.end());
+  CHECK(members == expected);
+
+  //an unseen key is not added by the queries
+  std::size_t size = uf.size();
+  CHECK(!uf.contains(make_key(nb_keys + 1)));
+  CHECK(uf.same_set(make_key(nb_keys + 1), make_key(nb_keys + 1)));
+  CHECK(!uf.same_set(make_key(nb_keys + 1), key));
+  CHECK(uf.size() == size);
+
+  uf.clear();
+  CHECK(uf.empty() && !uf.contains(key));
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<t_keyed_union_find<std::uint64_t> >("integers", 1, 50000, [](std::size_t i){return std::uint64_t(i) * 0x9E3779B97F4A7C15ULL;});
+  run<t_keyed_union_find<std::string> >("strings", 2, 5000, [](std::size_t i){return "key " + std::to_string(i);});
+  run<t_keyed_union_find<std::uint64_t, t_colliding_hash> >("colliding hash", 3, 500, [](std::size_t i){return std::uint64_t(i);});
+  run<t_keyed_union_find<std::uint64_t, std::hash<std::uint64_t>, t_union_find<false, t_vertex_index<std::uint32_t>, t_link_by_size> > >("32 bits vertices", 4, 20000, [](std::size_t i){return std::uint64_t(i);});
+  return 0;
+}
@@ -0,0 +1,146 @@
+#include <utils/union_find/kruskal.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//minimum spanning forest by Prim on the lightest edge between each
+//pair of vertices, in O(n^2) : returns its weight and sets the number
+//of components and the edges (u < v) of the forest
+template <class _weight>
+_weight prim(std::size_t n, const std::vector<std::tuple<std::size_t, std::size_t, _weight> >& edges, std::size_t& nb_components, std::vector<std::pair<std::size_t, std::size_t> >& forest)
+{
+  const _weight infinity = std::numeric_limits<_weight>::max();
+  std::vector<_weight> lightest(n * n, infinity);
+  for(const auto& e : edges)
+    {
+      std::size_t u = std::get<0>(e), v = std::get<1>(e);
+      if(u != v && std::get<2>(e) < lightest[u * n + v])
+	lightest[u * n + v] = lightest[v * n + u] = std::get<2>(e);
+    }
+
+  _weight total = _weight();
+  nb_components = 0;
+  forest.clear();
+  std::vector<bool> in_tree(n, false);
+  std::vector<_weight> distance(n, infinity);
+  std::vector<std::size_t> closest(n, n);
+  for(std::size_t root = 0; root < n; root++)
+    {
+      if(in_tree[root])
+	continue;
+      nb_components++;
+      distance[root] = _weight();
+      closest[root] = n;
+      while(true)
+	{
+	  std::size_t u = n;
+	  for(std::size_t v = 0; v < n; v++)
+	    if(!in_tree[v] && distance[v] != infinity && (u == n || distance[v] < distance[u]))
+	      u = v;
+	  if(u == n)
+	    break;
+	  in_tree[u] = true;
+	  if(closest[u] != n)
+	    {
+	      total += distance[u];
+	      forest.push_back(std::make_pair(std::min(u, closest[u]), std::max(u, closest[u])));
+	    }
+	  for(std::size_t v = 0; v < n; v++)
+	    if(!in_tree[v] && lightest[u * n + v] < distance[v])
+	      {
+		distance[v] = lightest[u * n + v];
+		closest[v] = u;
+	      }
+	}
+    }
+  std::sort(forest.begin(), forest.end());
+  return total;
+}
+
+//random graphs, sparse to dense so that the filter runs, on several
+//threads for the densest ones, checked against Prim; with distinct
+//weights, the forest is unique
+template <class _weight>
+void run(const char* name, unsigned seed, bool distinct_weights)
+{
+  typedef t_kruskal<_weight, std::uint32_t> kruskal_t;
+  typedef typename kruskal_t::edge_t        edge_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 60; iteration++)
+    {
+      std::size_t n = iteration % 10 == 0 ? 200 : 1 + generator() % 200;
+      std::size_t m = iteration % 10 == 0 ? 400 * n : iteration % 3 == 0 ? 50 * n : generator() % (3 * n);
+      //the distinct weights are a permutation of small integers, so
+      //that the totals are exact
+      std::vector<std::size_t> permutation(m);
+      for(std::size_t i = 0; i < m; i++)
+	permutation[i] = i;
+      std::shuffle(permutation.begin(), permutation.end(), generator);
+
+      std::vector<edge_t> edges;
+      std::vector<std::tuple<std::size_t, std::size_t, _weight> > reference;
+      for(std::size_t i = 0; i < m; i++)
+	{
+	  std::uint32_t u = std::uint32_t(generator() % n), v = std::uint32_t(generator() % n);
+	  _weight w = distinct_weights ? _weight(permutation[i]) : _weight(generator() % 10);
+	  edges.push_back(edge_t(u, v, w));
+	  reference.push_back(std::make_tuple(std::size_t(u), std::size_t(v), w));
+	}
+      std::shuffle(edges.begin(), edges.end(), generator);
+
+      std::size_t nb_components;
+      std::vector<std::pair<std::size_t, std::size_t> > expected;
+      _weight total = prim(n, reference, nb_components, expected);
+
+      kruskal_t kruskal(unsigned(iteration % 4));
+      kruskal.run(n, edges);
+      CHECK(kruskal.total_weight() == total);
+      CHECK(kruskal.number_of_components() == nb_components);
+      CHECK(kruskal.forest().size() == n - nb_components);
+      CHECK(kruskal.dendrogram().size() == n - nb_components);
+
+      //the forest is by increasing weights, and unique if the weights
+      //are
+      std::vector<std::pair<std::size_t, std::size_t> > forest;
+      for(std::size_t i = 0; i < kruskal.forest().size(); i++)
+	{
+	  const edge_t& e = kruskal.forest()[i];
+	  CHECK(i == 0 || std::get<2>(kruskal.forest()[i - 1]) <= std::get<2>(e));
+	  forest.push_back(std::make_pair(std::min<std::size_t>(std::get<0>(e), std::get<1>(e)), std::max<std::size_t>(std::get<0>(e), std::get<1>(e))));
+	}
+      std::sort(forest.begin(), forest.end());
+      if(distinct_weights)
+	CHECK(forest == expected);
+
+      //each merge joins two clusters alive at its height
+      std::vector<std::size_t> sizes(n, 1);
+      std::vector<bool> merged(2 * n, false);
+      for(std::size_t i = 0; i < kruskal.dendrogram().size(); i++)
+	{
+	  const typename kruskal_t::merge_t& merge = kruskal.dendrogram()[i];
+	  CHECK(merge.height == std::get<2>(kruskal.forest()[i]));
+	  CHECK(merge.first < n + i && merge.second < n + i && merge.first != merge.second);
+	  CHECK(!merged[merge.first] && !merged[merge.second]);
+	  merged[merge.first] = merged[merge.second] = true;
+	  CHECK(merge.size == sizes[merge.first] + sizes[merge.second]);
+	  sizes.push_back(merge.size);
+	}
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<double>("distinct weights", 1, true);
+  run<int>("repeated weights", 2, false);
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include <utils/union_find/labeling.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+typedef t_labeling<std::uint32_t> labeling_t;
+
+//labels the components by a breadth first search from each unlabeled
+//pixel in memory order, which gives the same labels as t_labeling
+template <class _pixel>
+std::size_t bfs_labels(const std::vector<_pixel>& image, int width, int height, int depth, int connectivity, std::vector<std::uint32_t>& labels)
+{
+  std::size_t k = 0;
+  labels.assign(image.size(), 0);
+  std::vector<std::size_t> queue;
+  for(std::size_t s = 0; s < image.size(); s++)
+    {
+      if(image[s] == 0 || labels[s] != 0)
+	continue;
+      labels[s] = std::uint32_t(++k);
+      queue.assign(1, s);
+      for(std::size_t i = 0; i < queue.size(); i++)
+	{
+	  int x = int(queue[i] % width), y = int(queue[i] / width % height), z = int(queue[i] / width / height);
+	  for(int dz = -1; dz <= 1; dz++)
+	    for(int dy = -1; dy <= 1; dy++)
+	      for(int dx = -1; dx <= 1; dx++)
+		{
+		  int distance = std::abs(dx) + std::abs(dy) + std::abs(dz);
+		  if(distance == 0 || (depth == 1 && dz != 0))
+		    continue;
+		  if((connectivity == 4 || connectivity == 6) && distance > 1)
+		    continue;
+		  int nx = x + dx, ny = y + dy, nz = z + dz;
+		  if(nx < 0 || ny < 0 || nz < 0 || nx >= width || ny >= height || nz >= depth)
+		    continue;
+		  std::size_t q = (std::size_t(nz) * height + ny) * width + nx;
+		  if(image[q] != 0 && labels[q] == 0)
+		    {
+		      labels[q] = std::uint32_t(k);
+		      queue.push_back(q);
+		    }
+		}
+	}
+    }
+  return k;
+}
+
+//random images of every density, labeled on several threads and
+//checked against the breadth first search
+template <class _pixel>
+void run(const char* name, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 200; iteration++)
+    {
+      int width = 1 + int(generator() % 70);
+      int height = 1 + int(generator() % 30);
+      int depth = iteration % 2 == 0 ? 1 : 1 + int(generator() % 6);
+      unsigned density = generator() % 101;
+      std::vector<_pixel> image(std::size_t(width) * height * depth);
+      for(_pixel& pixel : image)
+	pixel = generator() % 100 < density ? _pixel(1 + generator() % 3) : _pixel(0);
+
+      int connectivities[2] = {depth == 1 ? 4 : 6, depth == 1 ? 8 : 26};
+      for(int connectivity : connectivities)
+	{
+	  std::vector<std::uint32_t> expected;
+	  std::size_t k = bfs_labels(image, width, height, depth, connectivity, expected);
+	  for(unsigned nb_threads : {1u, 2u, 3u, 8u})
+	    {
+	      labeling_t labeling(nb_threads);
+	      std::vector<std::uint32_t> labels(image.size(), 0);
+	      std::size_t nb_components = depth == 1
+		? labeling.label(image.data(), width, height, labeling_t::connectivity_t(connectivity), labels.data())
+		: labeling.label(image.data(), width, height, depth, labeling_t::connectivity_t(connectivity), labels.data());
+	      CHECK(nb_components == k);
+	      CHECK(labeling.number_of_components() == k);
+	      CHECK(labels == expected);
+	    }
+	}
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+//the isolated pixels of a grid, as many components as the largest 8
+//bits label, then one more
+void run_overflow(void)
+{
+  typedef t_labeling<std::uint8_t> narrow_labeling_t;
+  for(std::size_t nb_components : {std::size_t(255), std::size_t(256)})
+    {
+      std::size_t width = 2 * nb_components;
+      std::vector<std::uint8_t> image(width * 2, 0);
+      for(std::size_t i = 0; i < nb_components; i++)
+	image[2 * i + (i % 2) * width] = 1;
+      std::vector<std::uint8_t> labels(image.size(), 7);
+      for(unsigned nb_threads : {1u, 2u})
+	for(int depth : {1, 2})
+	  {
+	    narrow_labeling_t labeling(nb_threads);
+	    bool thrown = false;
+	    try
+	      {
+		std::size_t k = depth == 1
+		  ? labeling.label(image.data(), width, 2, narrow_labeling_t::CONNECTIVITY_8, labels.data())
+		  : labeling.label(image.data(), width, 1, 2, narrow_labeling_t::CONNECTIVITY_26, labels.data());
+		CHECK(k == nb_components);
+		CHECK(*std::max_element(labels.begin(), labels.end()) == 255);
+	      }
+	    catch(const std::overflow_error&)
+	      {
+		thrown = true;
+	      }
+	    CHECK(thrown == (nb_components > 255));
+	  }
+    }
+  std::cout << "label overflow : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<std::uint8_t>("8 bits pixels", 1);
+  run<std::uint16_t>("16 bits pixels", 2);
+  run<float>("float pixels", 3);
+  run_overflow();
+  return 0;
+}
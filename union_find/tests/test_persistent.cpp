@@ -0,0 +1,77 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/persistent_union_find.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//random unions and make_set, each version being replayed in a
+//t_union_find : the leaders of the reference after each union give
+//connected_at and first_connected_time in every version
+template <class _vertex>
+void run(const char* name, unsigned seed)
+{
+  typedef t_persistent_union_find<_vertex>  persistent_t;
+  typedef typename persistent_t::version_t  version_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 20; iteration++)
+    {
+      std::size_t n = 1 + generator() % 150;
+      persistent_t uf;
+      t_union_find<> reference;
+      uf.make_sets(n);
+      reference.make_sets(n);
+
+      //leaders[t][u] is the leader of u in the version t, the vertices
+      //created later being absent
+      std::vector<std::vector<std::size_t> > leaders(1);
+      for(std::size_t u = 0; u < n; u++)
+	leaders[0].push_back(reference.find_set(u));
+      std::size_t nb_unions = generator() % (3 * n);
+      for(std::size_t i = 0; i < nb_unions; i++)
+	{
+	  if(generator() % 10 == 0)
+	    {
+	      CHECK(std::size_t(uf.make_set()) == reference.make_set());
+	      leaders.back().push_back(reference.size() - 1);
+	    }
+	  std::size_t u = generator() % reference.size(), v = generator() % reference.size();
+	  uf.union_sets(_vertex(u), _vertex(v));
+	  reference.union_sets(u, v);
+	  CHECK(uf.version() == i + 1);
+	  CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+	  leaders.push_back(std::vector<std::size_t>());
+	  for(std::size_t w = 0; w < reference.size(); w++)
+	    leaders.back().push_back(reference.find_set(w));
+	}
+      CHECK(same_sets(uf, reference, reference.size()));
+
+      std::size_t size = reference.size();
+      for(std::size_t i = 0; i < 500; i++)
+	{
+	  std::size_t u = generator() % size, v = generator() % size;
+	  version_t first = persistent_t::NEVER;
+	  for(version_t t = 0; t <= uf.version(); t++)
+	    {
+	      bool connected = u == v || (u < leaders[t].size() && v < leaders[t].size() && leaders[t][u] == leaders[t][v]);
+	      CHECK(uf.connected_at(_vertex(u), _vertex(v), t) == connected);
+	      if(connected && first == persistent_t::NEVER)
+		first = t;
+	    }
+	  CHECK(uf.first_connected_time(_vertex(u), _vertex(v)) == first);
+	  CHECK(uf.same_set(_vertex(u), _vertex(v)) == (first != persistent_t::NEVER));
+	}
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<std::size_t>("default", 1);
+  run<std::uint16_t>("16 bits", 2);
+  return 0;
+}
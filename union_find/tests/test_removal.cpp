@@ -0,0 +1,158 @@
+#include <utils/union_find.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//a reference of the vertices coming and going : each vertex made,
+//including on a recycled index, is a new vertex of a plain
+//t_union_find that is never removed, and is alive until removed
+struct t_reference{
+  t_union_find<>           uf;
+  std::vector<std::size_t> vertices;//reference vertex of each index
+  std::vector<bool>        alive;//of each reference vertex
+
+  std::size_t make_set(std::size_t u)
+  {
+    if(u >= this->vertices.size())
+      this->vertices.resize(u + 1);
+    this->vertices[u] = this->uf.make_set();
+    this->alive.push_back(true);
+    return this->vertices[u];
+  }
+
+  bool same_set(std::size_t u, std::size_t v)
+  {
+    return this->uf.find_set(this->vertices[u]) == this->uf.find_set(this->vertices[v]);
+  }
+
+  //number of vertices alive in each set, by leader
+  std::vector<std::size_t> sizes(void)
+  {
+    std::vector<std::size_t> sizes(this->uf.size(), 0);
+    for(std::size_t x = 0; x < this->uf.size(); x++)
+      if(this->alive[x])
+	sizes[this->uf.find_set(x)]++;
+    return sizes;
+  }
+};
+
+//checks the structure against the reference : the vertices alive,
+//their sets and sizes, the number of sets and the free indices
+template <class _union_find>
+void check_removal(_union_find& uf, t_reference& reference)
+{
+  std::vector<std::size_t> sizes = reference.sizes();
+  std::size_t nb_sets = 0, nb_free = 0;
+  for(std::size_t x = 0; x < sizes.size(); x++)
+    if(sizes[x] > 0)
+      nb_sets++;
+  CHECK(uf.number_of_independent_sets() == nb_sets);
+
+  std::vector<std::size_t> alive;
+  for(std::size_t u = 0; u < uf.size(); u++)
+    {
+      std::size_t x = reference.vertices[u];
+      CHECK(uf.is_removed(u) == !reference.alive[x]);
+      if(reference.alive[x])
+	{
+	  alive.push_back(u);
+	  CHECK(uf.set_size(u) == sizes[reference.uf.find_set(x)]);
+	}
+      else if(sizes[reference.uf.find_set(x)] == 0)
+	nb_free++;
+    }
+  CHECK(uf.number_of_free_vertices() == nb_free);
+  for(std::size_t i = 0; i < alive.size(); i++)
+    {
+      std::size_t j = (i * 7919) % alive.size();
+      CHECK((uf.find_set(alive[i]) == uf.find_set(alive[j])) == reference.same_set(alive[i], alive[j]));
+    }
+}
+
+//random make_set, unions and removals, compacted from time to time
+template <class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<false, t_free_list, _policies...> union_find_t;
+  typedef typename union_find_t::vertex_t               vertex_t;
+
+  std::mt19937 generator(seed);
+  union_find_t uf;
+  t_reference reference;
+  for(std::size_t round = 0; round < 40; round++)
+    {
+      for(std::size_t i = 0; i < 300; i++)
+	{
+	  unsigned type = generator() % 10;
+	  std::size_t u = uf.size() == 0 ? 0 : generator() % uf.size(), v = uf.size() == 0 ? 0 : generator() % uf.size();
+	  if(uf.size() == 0 || type < 3)
+	    {
+	      vertex_t w = uf.make_set();
+	      CHECK(!uf.is_removed(w));
+	      reference.make_set(w);
+	    }
+	  else if(uf.is_removed(u) || uf.is_removed(v))
+	    continue;
+	  else if(type < 7)
+	    {
+	      uf.union_sets(u, v);
+	      reference.uf.union_sets(reference.vertices[u], reference.vertices[v]);
+	    }
+	  else if(type < 9)
+	    {
+	      uf.remove_vertex(u);
+	      reference.alive[reference.vertices[u]] = false;
+	    }
+	  else
+	    {
+	      uf.remove_set(u);
+	      for(std::size_t w = 0; w < uf.size(); w++)
+		if(reference.same_set(u, w))
+		  reference.alive[reference.vertices[w]] = false;
+	    }
+	}
+      check_removal(uf, reference);
+
+      if(round % 4 == 3)
+	{
+	  //the vertices alive keep their order and their sets
+	  std::vector<vertex_t> indices = uf.compact();
+	  CHECK(indices.size() == reference.vertices.size());
+	  t_reference compacted;
+	  std::size_t k = 0;
+	  for(std::size_t u = 0; u < indices.size(); u++)
+	    {
+	      std::size_t x = reference.vertices[u];
+	      if(!reference.alive[x])
+		{
+		  CHECK(indices[u] == union_find_t::REMOVED);
+		  continue;
+		}
+	      CHECK(indices[u] == k++);
+	      compacted.make_set(indices[u]);
+	      for(std::size_t v = 0; v < u; v++)
+		if(reference.alive[reference.vertices[v]] && reference.same_set(u, v))
+		  {
+		    compacted.uf.union_sets(compacted.vertices[indices[u]], compacted.vertices[indices[v]]);
+		    break;
+		  }
+	    }
+	  CHECK(uf.size() == k && uf.number_of_free_vertices() == 0);
+	  reference = compacted;
+	  check_removal(uf, reference);
+	}
+    }
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<>("default", 1);
+  run<t_member_lists>("member lists", 2);
+  run<t_link_by_size, t_path_halving, t_vertex_index<std::uint32_t> >("link by size, 32 bits", 3);
+  return 0;
+}
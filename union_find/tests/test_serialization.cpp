@@ -0,0 +1,287 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/mapped_union_find.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <unistd.h>
+#include "check.hpp"
+
+using namespace utils;
+
+//leader of each vertex, the structure being compared with another one
+//by same_set
+template <class _union_find>
+std::vector<std::size_t> leaders_of(_union_find& uf)
+{
+  std::vector<std::size_t> leaders;
+  for(std::size_t u = 0; u < uf.size(); u++)
+    leaders.push_back(uf.find_set(u));
+  return leaders;
+}
+
+//returns true iff a and b have the same partition
+bool same_partition(const std::vector<std::size_t>& a, const std::vector<std::size_t>& b)
+{
+  if(a.size() != b.size())
+    return false;
+  std::vector<std::size_t> a_to_b(a.size(), a.size()), b_to_a(b.size(), b.size());
+  for(std::size_t u = 0; u < a.size(); u++)
+    {
+      if(a_to_b[a[u]] == a.size())
+	a_to_b[a[u]] = b[u];
+      if(b_to_a[b[u]] == b.size())
+	b_to_a[b[u]] = a[u];
+      if(a_to_b[a[u]] != b[u] || b_to_a[b[u]] != a[u])
+	return false;
+    }
+  return true;
+}
+
+//random unions on n vertices
+template <class _union_find>
+void fill(_union_find& uf, std::size_t n, std::size_t m, unsigned seed)
+{
+  std::mt19937 generator(seed);
+  uf.make_sets(n);
+  for(std::size_t i = 0; i < m; i++)
+    uf.union_sets(generator() % n, generator() % n);
+}
+
+//save and load with and without the log, the loaded structure
+//rewinding like the saved one
+template <class... _policies>
+void run_save_load(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, _policies...> union_find_t;
+  const char* path = "test_serialization.uf";
+
+  union_find_t uf;
+  fill(uf, 300, 200, seed);
+
+  //with the log, both structures rewind the same operations
+  union_find_t loaded;
+  CHECK(uf.save(path));
+  CHECK(loaded.load(path));
+  CHECK(loaded.size() == uf.size());
+  CHECK(loaded.number_of_independent_sets() == uf.number_of_independent_sets());
+  CHECK(loaded.log_size() == uf.log_size());
+  CHECK(same_partition(leaders_of(loaded), leaders_of(uf)));
+  for(std::size_t i = 0; i < 50; i++)
+    {
+      CHECK(loaded.rewind() == uf.rewind());
+      CHECK(loaded.number_of_independent_sets() == uf.number_of_independent_sets());
+      CHECK(same_partition(leaders_of(loaded), leaders_of(uf)));
+    }
+
+  //without the log, the loaded state is the oldest one
+  union_find_t bare;
+  CHECK(uf.save(path, false));
+  CHECK(bare.load(path));
+  CHECK(bare.log_size() == 0);
+  CHECK(bare.rewind() == union_find_t::NONE);
+  CHECK(same_partition(leaders_of(bare), leaders_of(uf)));
+
+  //a file saved with other policies is refused, the structure being
+  //cleared
+  t_union_find<false, t_vertex_index<std::uint8_t> > other;
+  CHECK(!other.load(path));
+  CHECK(other.size() == 0);
+  CHECK(!bare.load("test_serialization.missing"));
+  CHECK(bare.size() == 0);
+
+  std::remove(path);
+  std::cout << "save / load, " << name << " : ok" << std::endl;
+}
+
+//mapped open of a saved file, read-only and copy-on-write
+template <class... _policies>
+void run_mapped(const char* name, unsigned seed)
+{
+  typedef t_union_find<false, _policies...> union_find_t;
+  typedef t_mapped_union_find<_policies...> mapped_t;
+  const char* path = "test_serialization.uf";
+
+  union_find_t uf;
+  fill(uf, 500, 300, seed);
+  CHECK(uf.save(path));
+  std::vector<std::size_t> leaders = leaders_of(uf);
+
+  {
+    mapped_t mapped;
+    CHECK(mapped.open(path, mapped_t::READ_ONLY));
+    CHECK(mapped.size() == uf.size());
+    CHECK(mapped.number_of_independent_sets() == uf.number_of_independent_sets());
+    CHECK(same_partition(leaders_of(mapped), leaders));
+    CHECK(mapped.union_sets(0, 1) == mapped_t::NONE);
+    CHECK(mapped.number_of_independent_sets() == uf.number_of_independent_sets());
+  }
+
+  //the unions modify private copies of the pages, never the file
+  std::mt19937 generator(seed);
+  {
+    mapped_t mapped;
+    CHECK(mapped.open(path, mapped_t::COPY_ON_WRITE));
+    for(std::size_t i = 0; i < 200; i++)
+      {
+	std::size_t u = generator() % uf.size(), v = generator() % uf.size();
+	mapped.union_sets(u, v);
+	uf.union_sets(u, v);
+      }
+    CHECK(mapped.number_of_independent_sets() == uf.number_of_independent_sets());
+    CHECK(same_partition(leaders_of(mapped), leaders_of(uf)));
+  }
+  {
+    mapped_t mapped;
+    CHECK(mapped.open(path, mapped_t::READ_ONLY));
+    CHECK(same_partition(leaders_of(mapped), leaders));
+  }
+
+  //a file saved with other policies is refused
+  t_mapped_union_find<t_vertex_index<std::uint8_t> > other;
+  CHECK(!other.open(path));
+  CHECK(!other.is_open());
+
+  std::remove(path);
+  std::cout << "mapped, " << name << " : ok" << std::endl;
+}
+
+//overwrites the bytes of value at the offset of the file
+template <class _value>
+void patch(const char* path, std::uint64_t offset, _value value)
+{
+  std::FILE* file = std::fopen(path, "r+b");
+  CHECK(file != nullptr);
+  CHECK(std::fseek(file, long(offset), SEEK_SET) == 0);
+  CHECK(std::fwrite(&value, sizeof(value), 1, file) == 1);
+  std::fclose(file);
+}
+
+//header of a saved file
+t_union_find_file_header header_of(const char* path)
+{
+  t_union_find_file_header header;
+  std::FILE* file = std::fopen(path, "rb");
+  CHECK(file != nullptr);
+  CHECK(std::fread(&header, sizeof(header), 1, file) == 1);
+  std::fclose(file);
+  return header;
+}
+
+//returns true iff both load and the mapped open refuse the file
+template <class... _policies>
+bool refused(const char* path)
+{
+  t_union_find<true, _policies...> loaded;
+  t_mapped_union_find<_policies...> mapped;
+  bool refused = !loaded.load(path) && loaded.size() == 0 && !mapped.open(path) && !mapped.is_open();
+  return refused;
+}
+
+//corrupt headers and sections are refused by load and open
+template <class... _policies>
+void run_corrupt(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, _policies...> union_find_t;
+  typedef typename union_find_t::vertex_t  vertex_t;
+  const char* path = "test_serialization.uf";
+
+  union_find_t uf;
+  fill(uf, 100, 60, seed);
+  CHECK(uf.save(path));
+  t_union_find_file_header header = header_of(path);
+  const std::uint64_t size_offset = offsetof(t_union_find_file_header, size);
+  const std::uint64_t nb_cc_offset = offsetof(t_union_find_file_header, nb_cc);
+  const std::uint64_t log_offset = offsetof(t_union_find_file_header, log_words);
+  const std::uint64_t parents = header.parents_offset();
+
+  //the untouched file is accepted
+  CHECK(uf.save(path));
+  CHECK(!refused<_policies...>(path));
+
+  //more vertices or log words than the file holds, before any
+  //allocation
+  patch(path, size_offset, std::uint64_t(1) << 40);
+  CHECK(refused<_policies...>(path));
+  CHECK(uf.save(path));
+  patch(path, size_offset, std::uint64_t(-1));
+  CHECK(refused<_policies...>(path));
+  CHECK(uf.save(path));
+  patch(path, log_offset, std::uint64_t(1) << 50);
+  CHECK(refused<_policies...>(path));
+
+  //a wrong number of sets
+  CHECK(uf.save(path));
+  patch(path, nb_cc_offset, std::uint64_t(uf.number_of_independent_sets() + 1));
+  CHECK(refused<_policies...>(path));
+
+  //a parent out of the structure
+  CHECK(uf.save(path));
+  patch(path, parents + 3 * sizeof(vertex_t), vertex_t(uf.size() + 5));
+  CHECK(refused<_policies...>(path));
+
+  //two parents making a cycle
+  CHECK(uf.save(path));
+  patch(path, parents, vertex_t(1));
+  patch(path, parents + sizeof(vertex_t), vertex_t(0));
+  CHECK(refused<_policies...>(path));
+
+  //a truncated file
+  CHECK(uf.save(path, false));
+  {
+    std::FILE* file = std::fopen(path, "r+b");
+    CHECK(file != nullptr);
+    CHECK(::ftruncate(::fileno(file), off_t(parents + uf.size() / 2 * sizeof(vertex_t))) == 0);
+    std::fclose(file);
+  }
+  CHECK(refused<_policies...>(path));
+
+  std::remove(path);
+  std::cout << "corrupt files, " << name << " : ok" << std::endl;
+}
+
+//a member list leaving the structure, or two vertices with the same
+//next member, are refused by load
+void run_corrupt_members(void)
+{
+  typedef t_union_find<false, t_member_lists> union_find_t;
+  const char* path = "test_serialization.uf";
+
+  union_find_t uf;
+  fill(uf, 100, 60, 11);
+  CHECK(uf.save(path));
+  t_union_find_file_header header = header_of(path);
+
+  union_find_t loaded;
+  CHECK(loaded.load(path));
+  patch(path, header.members_offset() + 5 * sizeof(std::size_t), std::size_t(1000));
+  CHECK(!loaded.load(path));
+  CHECK(uf.save(path));
+  patch(path, header.members_offset() + 5 * sizeof(std::size_t), std::size_t(7));
+  patch(path, header.members_offset() + 6 * sizeof(std::size_t), std::size_t(7));
+  CHECK(!loaded.load(path));
+
+  std::remove(path);
+  std::cout << "corrupt member lists : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run_save_load<>("default", 1);
+  run_save_load<t_path_halving, t_link_by_size>("path halving, link by size", 2);
+  run_save_load<t_vertex_index<std::uint32_t>, t_weights_in_parents>("weights in parents", 3);
+  run_save_load<t_member_lists, t_no_compression>("member lists", 4);
+
+  run_mapped<>("default", 5);
+  run_mapped<t_path_splitting, t_link_by_size>("path splitting, link by size", 6);
+  run_mapped<t_vertex_index<std::uint32_t>, t_weights_in_parents>("weights in parents", 7);
+
+  run_corrupt<>("default", 8);
+  run_corrupt<t_vertex_index<std::uint32_t>, t_weights_in_parents, t_link_by_size>("weights in parents", 9);
+  run_corrupt<t_vertex_index<std::uint16_t>, t_path_halving>("16 bits", 10);
+  run_corrupt_members();
+
+  return 0;
+}
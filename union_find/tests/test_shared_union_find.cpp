@@ -0,0 +1,137 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/shared_union_find.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "check.hpp"
+
+using namespace utils;
+
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+//name of a segment of this process, so that tests running at once do
+//not share it
+std::string segment_name(const char* suffix)
+{
+  return "/test_shared_union_find_" + std::to_string(::getpid()) + "_" + suffix;
+}
+
+//random edges unioned by nb_processes processes, each attaching the
+//segment and unioning every nb_processes-th edge with nb_threads
+//threads, then checked in the creator against the serial reference
+void run_processes(std::size_t n, std::size_t m, unsigned nb_processes, unsigned nb_threads, unsigned seed)
+{
+  std::string name = segment_name("processes");
+  std::mt19937 generator(seed);
+  std::vector<edge_t> edges;
+  t_union_find<> reference;
+  reference.make_sets(n);
+  for(std::size_t i = 0; i < m; i++)
+    {
+      edges.push_back(edge_t(generator() % n, generator() % n));
+      reference.union_sets(edges.back().first, edges.back().second);
+    }
+
+  t_shared_union_find::remove(name.c_str());
+  t_shared_union_find uf;
+  CHECK(uf.create(name.c_str(), n));
+  CHECK(uf.is_attached() && uf.size() == n && uf.number_of_independent_sets() == n);
+
+  //the workers check their own unions, and exit with a failure if a
+  //check fails
+  for(unsigned p = 0; p < nb_processes; p++)
+    if(::fork() == 0)
+      {
+	t_shared_union_find worker;
+	CHECK(worker.attach(name.c_str()) && worker.size() == n);
+	std::vector<std::thread> threads;
+	for(unsigned t = 0; t < nb_threads; t++)
+	  threads.push_back(std::thread([&worker, &edges, p, t, nb_processes, nb_threads](){
+		for(std::size_t i = p + nb_processes * t; i < edges.size(); i += nb_processes * nb_threads)
+		  {
+		    std::size_t leader = worker.union_sets(edges[i].first, edges[i].second);
+		    CHECK(worker.same_set(edges[i].first, leader) && worker.same_set(edges[i].second, leader));
+		  }
+	      }));
+	for(std::thread& thread : threads)
+	  thread.join();
+	worker.detach();
+	std::_Exit(EXIT_SUCCESS);
+      }
+  for(unsigned p = 0; p < nb_processes; p++)
+    {
+      int status = 0;
+      CHECK(::wait(&status) > 0);
+      CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+    }
+
+  //the partition built by the workers is read in place, and by another
+  //attachment of the same process
+  CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+  CHECK(same_sets(uf, reference, n));
+  t_shared_union_find other;
+  CHECK(other.attach(name.c_str()) && other.size() == n);
+  CHECK(other.number_of_independent_sets() == reference.number_of_independent_sets());
+  CHECK(same_sets(other, reference, n));
+  std::vector<std::size_t> leaders;
+  other.leaders(std::back_inserter(leaders));
+  CHECK(leaders.size() == reference.number_of_independent_sets());
+
+  //the segment outlives its name while attached
+  CHECK(t_shared_union_find::remove(name.c_str()));
+  CHECK(!other.attach(name.c_str()) && !other.is_attached());
+  CHECK(same_sets(uf, reference, n));
+  uf.detach();
+  CHECK(!uf.is_attached() && uf.empty() && uf.number_of_independent_sets() == 0);
+}
+
+//the segments that cannot be created or attached
+void run_failures(void)
+{
+  std::string name = segment_name("failures");
+  t_shared_union_find::remove(name.c_str());
+  t_shared_union_find uf, other;
+  CHECK(!uf.attach(name.c_str()) && !uf.is_attached());
+  CHECK(uf.create(name.c_str(), 10));
+  CHECK(!other.create(name.c_str(), 10) && !other.is_attached());
+  CHECK(t_shared_union_find::remove(name.c_str()));
+  CHECK(!t_shared_union_find::remove(name.c_str()));
+
+  //a segment shorter than the header, then one whose creator did not
+  //finish to initialize it
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  CHECK(fd >= 0);
+  CHECK(::ftruncate(fd, 16) == 0);
+  CHECK(!other.attach(name.c_str()) && !other.is_attached());
+  CHECK(::ftruncate(fd, 64 + 10 * 8) == 0);
+  CHECK(!other.attach(name.c_str()) && !other.is_attached());
+  ::close(fd);
+  CHECK(t_shared_union_find::remove(name.c_str()));
+
+  //an empty segment
+  CHECK(uf.create(name.c_str(), 0));
+  CHECK(uf.empty() && uf.number_of_independent_sets() == 0);
+  CHECK(other.attach(name.c_str()) && other.empty());
+  CHECK(t_shared_union_find::remove(name.c_str()));
+}
+
+int main(int argc, char** argv)
+{
+  run_processes(20000, 15000, 4, 1, 1);
+  run_processes(3000, 30000, 3, 2, 2);
+  run_processes(2, 100, 2, 2, 3);
+  std::cout << "unions by several processes : ok" << std::endl;
+
+  run_failures();
+  std::cout << "create and attach failures : ok" << std::endl;
+  return 0;
+}
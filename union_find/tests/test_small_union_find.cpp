@@ -0,0 +1,136 @@
+#include <utils/union_find.hpp>
+#include <utils/union_find/small_union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+#if __cplusplus >= 201402L
+//a structure built and queried in a constant expression
+constexpr std::size_t constant_components(void)
+{
+  t_small_union_find<8> uf;
+  uf.make_sets(8);
+  uf.union_sets(0, 1);
+  uf.union_sets(2, 3);
+  uf.union_sets(1, 3);
+  return uf.number_of_independent_sets() * 100 + uf.set_size(0) * 10 + (uf.set_mask(2) == 0xf ? 1 : 0);
+}
+static_assert(constant_components() == 541, "t_small_union_find in a constant expression");
+#endif
+
+//checks the bitmask of the set of u, for N <= 64
+template <class _small>
+void check_mask(_small& uf, typename _small::vertex_t u, const std::vector<typename _small::vertex_t>& members, std::true_type)
+{
+  std::uint64_t mask = 0;
+  for(typename _small::vertex_t v : members)
+    mask |= std::uint64_t(1) << v;
+  CHECK(uf.set_mask(u) == mask);
+}
+
+template <class _small>
+void check_mask(_small&, typename _small::vertex_t, const std::vector<typename _small::vertex_t>&, std::false_type)
+{
+}
+
+//random make_set and unions up to the capacity, checked against the
+//reference on the partition, the sizes, the masks and the members
+template <std::size_t N>
+void run(unsigned seed)
+{
+  typedef t_small_union_find<N>               small_t;
+  typedef typename small_t::vertex_t          vertex_t;
+  typedef std::pair<vertex_t, vertex_t>       edge_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 10; iteration++)
+    {
+      small_t uf;
+      t_union_find<> reference;
+      std::size_t n = 1 + generator() % N;
+      uf.make_sets(n / 2);
+      reference.make_sets(n / 2);
+      while(uf.size() < n)
+	{
+	  CHECK(std::size_t(uf.make_set()) == reference.make_set());
+	  for(std::size_t i = 0, m = generator() % 3; i < m; i++)
+	    {
+	      std::size_t u = generator() % uf.size(), v = generator() % uf.size();
+	      std::size_t leader = uf.union_sets(vertex_t(u), vertex_t(v));
+	      reference.union_sets(u, v);
+	      CHECK(uf.find_set(vertex_t(u)) == leader && uf.find_set(vertex_t(v)) == leader);
+	    }
+	}
+      CHECK(uf.size() == n && !uf.empty());
+      CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+      CHECK(same_sets(uf, reference, n));
+
+      //the batch operations
+      std::vector<edge_t> edges;
+      for(std::size_t i = 0, m = generator() % (n + 1); i < m; i++)
+	{
+	  edges.push_back(edge_t(vertex_t(generator() % n), vertex_t(generator() % n)));
+	  reference.union_sets(edges.back().first, edges.back().second);
+	}
+      if(iteration % 2 == 0)
+	uf.union_batch(edges.begin(), edges.end());
+      else
+	CHECK(uf.connected_components(edges) == reference.number_of_independent_sets());
+      CHECK(same_sets(uf, reference, n));
+      std::vector<vertex_t> vertices, leaders;
+      std::vector<bool> same;
+      for(std::size_t u = 0; u < n; u++)
+	vertices.push_back(vertex_t(u));
+      uf.find_batch(vertices.begin(), vertices.end(), std::back_inserter(leaders));
+      uf.same_set_batch(edges.begin(), edges.end(), std::back_inserter(same));
+      CHECK(leaders.size() == n && same.size() == edges.size());
+      for(std::size_t u = 0; u < n; u++)
+	CHECK(leaders[u] == uf.find_set(vertex_t(u)));
+      for(std::size_t i = 0; i < edges.size(); i++)
+	CHECK(same[i]);
+
+      //the sizes, masks and members of the sets
+      std::vector<std::size_t> sizes(n, 0);
+      for(std::size_t u = 0; u < n; u++)
+	sizes[reference.find_set(u)]++;
+      std::vector<vertex_t> roots;
+      uf.leaders(std::back_inserter(roots));
+      CHECK(roots.size() == reference.number_of_independent_sets());
+      for(std::size_t u = 0; u < n; u += 1 + n / 50)
+	{
+	  CHECK(uf.set_size(vertex_t(u)) == sizes[reference.find_set(u)]);
+	  std::vector<vertex_t> members, expected;
+	  uf.independent_set(vertex_t(u), std::back_inserter(members));
+	  for(std::size_t v = 0; v < n; v++)
+	    if(reference.find_set(v) == reference.find_set(u))
+	      expected.push_back(vertex_t(v));
+	  CHECK(members == expected);
+	  check_mask(uf, vertex_t(u), expected, std::integral_constant<bool, small_t::WITH_MASKS>());
+	}
+
+      uf.reset();
+      CHECK(uf.size() == n && uf.number_of_independent_sets() == n && uf.set_size(0) == 1);
+      uf.clear();
+      CHECK(uf.empty() && uf.number_of_independent_sets() == 0);
+    }
+  std::cout << "capacity " << N << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<1>(1);
+  run<7>(2);
+  run<64>(3);
+  run<65>(4);
+  run<300>(5);
+  run<70000>(6);
+  return 0;
+}
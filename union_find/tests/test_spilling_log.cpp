@@ -0,0 +1,131 @@
+#include <utils/union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//checks the structure with the spilling log against the one with the
+//whole log in memory : the partition, the log and the memory bound
+template <class _spilling, class _memory>
+void check_log(_spilling& uf, _memory& reference, std::size_t hot_words)
+{
+  CHECK(uf.size() == reference.size());
+  CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+  CHECK(uf.log_size() == reference.log_size());
+  CHECK(uf.log_memory() <= hot_words * sizeof(typename _spilling::vertex_t));
+}
+
+//long random histories of make_set, unions and finds run on both logs
+//with the same policies : rewinds without checkpoints first, so that
+//the log grows well beyond the memory, then nested checkpoints on top
+//of the spilled words, and a full rewind at the end. The trees stay
+//shallower than HOT_WORDS / 4, so that no path is split and both logs
+//hold the same words
+template <std::size_t HOT_WORDS, class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, t_spilling_log<HOT_WORDS>, _policies...> union_find_t;
+  typedef t_union_find<true, t_memory_log, _policies...>              reference_t;
+  typedef typename union_find_t::mark_t                              mark_t;
+  typedef typename reference_t::mark_t                               reference_mark_t;
+
+  std::mt19937 generator(seed);
+  union_find_t uf;
+  reference_t reference;
+  uf.make_sets(8);
+  reference.make_sets(8);
+
+  std::vector<std::pair<mark_t, reference_mark_t> > marks;
+  for(std::size_t step = 0; step < 30000; step++)
+    {
+      bool with_marks = step >= 20000;
+      unsigned operation = generator() % 100;
+      std::size_t n = uf.size();
+      std::size_t u = n == 0 ? 0 : generator() % n, v = n == 0 ? 0 : generator() % n;
+      if(n == 0 || (operation < 10 && n < 1000))
+	CHECK(uf.make_set() == reference.make_set());
+      else if(operation < 60)
+	CHECK(uf.union_sets(u, v) == reference.union_sets(u, v));
+      else if(operation < 80)
+	CHECK(uf.find_set(u) == reference.find_set(u));
+      else if(!with_marks)
+	{
+	  //a few rewinds, mostly just before one of the last vertices was
+	  //made, so that the log keeps growing
+	  std::size_t w = n - 1 - generator() % std::min<std::size_t>(n, 8);
+	  unsigned type = generator() % 40;
+	  if(type < 3)
+	    CHECK(int(uf.rewind()) == int(reference.rewind()));
+	  else if(type == 3)
+	    {
+	      uf.rewind(w);
+	      reference.rewind(w);
+	    }
+	  else if(type == 4 && operation < 85)
+	    {
+	      uf.rewind(u, w);
+	      reference.rewind(u, w);
+	    }
+	}
+      else if(operation < 88 || marks.empty())
+	marks.push_back(std::make_pair(uf.mark(), reference.mark()));
+      else if(operation < 96)
+	{
+	  //rollback to the last checkpoint or to an enclosing one, that
+	  //stays alive
+	  std::size_t i = marks.size() - 1 - (generator() % 4 == 0 ? generator() % marks.size() : 0);
+	  uf.rollback_to(marks[i].first);
+	  reference.rollback_to(marks[i].second);
+	  marks.resize(i + 1);
+	}
+      else if(marks.size() > 1)
+	{
+	  //commit a nested checkpoint, the outermost one keeping the log
+	  std::size_t i = 1 + generator() % (marks.size() - 1);
+	  uf.commit(marks[i].first);
+	  reference.commit(marks[i].second);
+	  marks.resize(i);
+	}
+      check_log(uf, reference, HOT_WORDS);
+      if(step % 1000 == 999)
+	CHECK(same_sets(uf, reference, uf.size()));
+
+      //the structure is moved, with its file, from time to time
+      if(step % 7000 == 6999)
+	{
+	  union_find_t moved(std::move(uf));
+	  uf = std::move(moved);
+	  check_log(uf, reference, HOT_WORDS);
+	}
+      if(step == 19999)
+	CHECK(uf.log_size() > 8 * HOT_WORDS);
+    }
+
+  //the whole history is read back from the file, below the outermost
+  //checkpoint that is not used anymore
+  uf.rollback_to(marks.front().first);
+  reference.rollback_to(marks.front().second);
+  CHECK(same_sets(uf, reference, uf.size()));
+  while(reference.log_size() > 0)
+    {
+      CHECK(int(uf.rewind()) == int(reference.rewind()));
+      check_log(uf, reference, HOT_WORDS);
+    }
+  CHECK(uf.rewind() == union_find_t::NONE);
+  CHECK(uf.size() == reference.size() && same_sets(uf, reference, uf.size()));
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<64>("64 words", 1);
+  run<128, t_link_by_size, t_path_halving>("128 words, link by size, path halving", 2);
+  run<64, t_vertex_index<std::uint32_t>, t_weights_in_parents, t_link_by_size>("64 words, 32 bits, weights in parents", 3);
+  run<128, t_member_lists, t_path_splitting>("128 words, member lists, path splitting", 4);
+  return 0;
+}
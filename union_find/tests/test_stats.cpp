@@ -0,0 +1,155 @@
+#include <utils/union_find.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+//sum of a histogram
+std::size_t total(const std::size_t* histogram)
+{
+  std::size_t sum = 0;
+  for(std::size_t b = 0; b < t_union_find_stats::NB_BUCKETS; b++)
+    sum += histogram[b];
+  return sum;
+}
+
+//2^k vertices unioned pairwise by size without compression make a
+//binomial tree, whichever leader is chosen on ties : C(k, d) vertices
+//at the depth d, so that the finds of all the vertices walk exactly
+//k 2^(k-1) vertices
+void run_binomial(std::size_t k)
+{
+  t_union_find<false, t_no_compression, t_link_by_size, t_stats> uf;
+  std::size_t n = std::size_t(1) << k;
+  uf.make_sets(n);
+  for(std::size_t width = 1; width < n; width *= 2)
+    for(std::size_t u = 0; u < n; u += 2 * width)
+      uf.union_sets(u, u + width);
+  CHECK(uf.stats().nb_make_sets == n);
+  CHECK(uf.stats().nb_unions == n - 1 && uf.stats().nb_failed_unions == 0);
+  CHECK(uf.stats().nb_finds == 2 * (n - 1));
+
+  uf.reset_stats();
+  CHECK(uf.stats().nb_finds == 0 && uf.stats().nb_unions == 0 && total(uf.stats().path_lengths) == 0);
+  for(std::size_t u = 0; u < n; u++)
+    uf.find_set(u);
+  t_union_find_stats stats = uf.stats();
+  CHECK(stats.nb_finds == n);
+  CHECK(stats.nb_path_vertices == k * n / 2);
+  CHECK(stats.nb_compression_writes == 0);
+  std::vector<std::size_t> expected(t_union_find_stats::NB_BUCKETS, 0);
+  for(std::size_t d = 0, binomial = 1; d <= k; binomial = binomial * (k - d) / (d + 1), d++)
+    expected[t_union_find_stats::bucket(d)] += binomial;
+  CHECK(std::equal(expected.begin(), expected.end(), stats.path_lengths));
+  CHECK(stats.mean_path_length() == double(k) / 2);
+
+  //one leader, of size n
+  CHECK(total(stats.weights) == 1 && stats.weights[t_union_find_stats::bucket(n)] == 1);
+  std::cout << "binomial tree of 2^" << k << " vertices : ok" << std::endl;
+}
+
+//random operations counted on the side, the weights of the leaders
+//being checked against the sizes of the sets of a reference
+template <class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, t_stats, t_link_by_size, _policies...> union_find_t;
+
+  std::mt19937 generator(seed);
+  union_find_t uf;
+  t_union_find<> reference;
+  std::size_t nb_make_sets = 0, nb_finds = 0, nb_unions = 0, nb_failed_unions = 0, nb_rewinds = 0, peak_log_words = 0;
+  for(std::size_t i = 0; i < 20000; i++)
+    {
+      unsigned type = generator() % 20;
+      if(uf.size() < 2 || type == 0)
+	{
+	  std::size_t m = 1 + generator() % 3;
+	  uf.make_sets(m);
+	  reference.make_sets(m);
+	  nb_make_sets += m;
+	}
+      else if(type < 8)
+	{
+	  std::size_t u = generator() % uf.size(), v = generator() % uf.size();
+	  nb_failed_unions += reference.find_set(u) == reference.find_set(v) ? 1 : 0;
+	  uf.union_sets(u, v);
+	  reference.union_sets(u, v);
+	  nb_unions++;
+	  nb_finds += 2;
+	}
+      else if(type < 18)
+	{
+	  //the second find of a vertex walks no more vertices than the
+	  //first one, and after a full compression at most one vertex
+	  //without rewriting any parent
+	  std::size_t u = generator() % uf.size();
+	  t_union_find_stats before = uf.stats();
+	  uf.find_set(u);
+	  t_union_find_stats middle = uf.stats();
+	  uf.find_set(u);
+	  t_union_find_stats after = uf.stats();
+	  CHECK(after.nb_path_vertices - middle.nb_path_vertices <= middle.nb_path_vertices - before.nb_path_vertices);
+	  if(std::is_same<typename union_find_t::compression_t, t_full_compression>::value)
+	    CHECK(after.nb_path_vertices - middle.nb_path_vertices <= 1 && after.nb_compression_writes == middle.nb_compression_writes);
+	  nb_finds += 2;
+	}
+      else
+	{
+	  //the rewound operation is undone in the reference by rebuilding
+	  //it from the leaders given by find_batch, that is not counted
+	  if(uf.rewind() != union_find_t::NONE)
+	    nb_rewinds++;
+	  std::vector<std::size_t> vertices(uf.size()), leaders;
+	  for(std::size_t u = 0; u < uf.size(); u++)
+	    vertices[u] = u;
+	  uf.find_batch(vertices.begin(), vertices.end(), std::back_inserter(leaders));
+	  t_union_find<> rebuilt;
+	  rebuilt.make_sets(uf.size());
+	  for(std::size_t u = 0; u < uf.size(); u++)
+	    rebuilt.union_sets(u, leaders[u]);
+	  reference = rebuilt;
+	}
+      peak_log_words = std::max(peak_log_words, uf.log_size());
+    }
+
+  t_union_find_stats stats = uf.stats();
+  CHECK(stats.nb_make_sets == nb_make_sets);
+  CHECK(stats.nb_unions == nb_unions && stats.nb_failed_unions == nb_failed_unions);
+  CHECK(stats.nb_finds == nb_finds && total(stats.path_lengths) == nb_finds);
+  CHECK(stats.nb_rewinds == nb_rewinds);
+  CHECK(stats.nb_compression_writes <= stats.nb_path_vertices);
+  CHECK(stats.log_words == uf.log_size() && stats.peak_log_words >= peak_log_words);
+  CHECK(stats.log_bytes >= stats.log_words * sizeof(typename union_find_t::vertex_t));
+
+  std::vector<std::size_t> sizes(reference.size(), 0), expected(t_union_find_stats::NB_BUCKETS, 0);
+  for(std::size_t u = 0; u < reference.size(); u++)
+    sizes[reference.find_set(u)]++;
+  for(std::size_t size : sizes)
+    if(size > 0)
+      expected[t_union_find_stats::bucket(size)]++;
+  CHECK(std::equal(expected.begin(), expected.end(), stats.weights));
+
+  std::ostringstream json;
+  stats.write_json(json);
+  CHECK(json.str().find("\"unions\": " + std::to_string(nb_unions) + ",") != std::string::npos);
+  std::cout << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run_binomial(1);
+  run_binomial(10);
+  run<>("full compression", 1);
+  run<t_path_halving, t_vertex_index<std::uint32_t>, t_weights_in_parents>("path halving, weights in parents", 2);
+  run<t_path_splitting, t_member_lists>("path splitting, member lists", 3);
+  return 0;
+}
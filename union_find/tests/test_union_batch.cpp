@@ -0,0 +1,93 @@
+#include <utils/union_find.hpp>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "check.hpp"
+
+using namespace utils;
+
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+//random edges, more or fewer than the vertices so that both the
+//serial and the concurrent paths run, unioned in batch after some
+//serial unions and compared with the serial loop
+template <class... _policies>
+void run(const char* name, unsigned seed)
+{
+  typedef t_union_find<true, _policies...> union_find_t;
+
+  std::mt19937 generator(seed);
+  for(std::size_t iteration = 0; iteration < 24; iteration++)
+    {
+      std::size_t n = 1 + generator() % 5000;
+      std::size_t m = iteration % 3 == 0 ? generator() % n : n + generator() % (3 * n);
+      std::size_t nb_before = iteration % 2 == 0 ? 0 : generator() % n;
+      unsigned nb_threads = 1 + unsigned(iteration % 8);
+
+      union_find_t uf;
+      t_union_find<> reference;
+      uf.make_sets(n);
+      reference.make_sets(n);
+      for(std::size_t i = 0; i < nb_before; i++)
+	{
+	  std::size_t u = generator() % n, v = generator() % n;
+	  uf.union_sets(u, v);
+	  reference.union_sets(u, v);
+	}
+      t_union_find<> before = reference;
+      std::size_t log_before = uf.log_size();
+
+      std::vector<edge_t> edges;
+      for(std::size_t i = 0; i < m; i++)
+	{
+	  edges.push_back(edge_t(generator() % n, generator() % n));
+	  reference.union_sets(edges.back().first, edges.back().second);
+	}
+      uf.union_batch(edges.begin(), edges.end(), nb_threads);
+      CHECK(uf.number_of_independent_sets() == reference.number_of_independent_sets());
+      CHECK(same_sets(uf, reference, n));
+
+      //the batch is recorded, and rewinds back to the state before it
+      while(uf.log_size() > log_before)
+	CHECK(uf.rewind() != union_find_t::NONE);
+      CHECK(uf.number_of_independent_sets() == before.number_of_independent_sets());
+      CHECK(same_sets(uf, before, n));
+    }
+  std::cout << "union_batch, " << name << " : ok" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  run<>("default", 1);
+  run<t_path_halving, t_link_by_size, t_vertex_index<std::uint32_t> >("path halving, link by size, 32 bits", 2);
+  run<t_member_lists, t_no_compression>("member lists", 3);
+
+  //connected_components on pairs and on tuples
+  std::mt19937 generator(4);
+  std::size_t n = 20000;
+  std::vector<edge_t> pairs;
+  std::vector<std::tuple<std::uint32_t, std::uint32_t, float> > tuples;
+  t_union_find<> reference;
+  reference.make_sets(n);
+  for(std::size_t i = 0; i < 2 * n; i++)
+    {
+      pairs.push_back(edge_t(generator() % n, generator() % (n / 2)));
+      tuples.push_back(std::make_tuple(std::uint32_t(pairs.back().first), std::uint32_t(pairs.back().second), 1.f));
+      reference.union_sets(pairs.back().first, pairs.back().second);
+    }
+  for(unsigned nb_threads : {1u, 4u})
+    {
+      t_union_find<> from_pairs, from_tuples;
+      from_pairs.make_sets(n);
+      from_tuples.make_sets(n);
+      CHECK(from_pairs.connected_components(pairs, nb_threads) == reference.number_of_independent_sets());
+      CHECK(from_tuples.connected_components(tuples, nb_threads) == reference.number_of_independent_sets());
+      CHECK(same_sets(from_pairs, reference, n));
+      CHECK(same_sets(from_tuples, reference, n));
+    }
+  std::cout << "connected_components : ok" << std::endl;
+  return 0;
+}